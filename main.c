@@ -7,6 +7,7 @@
 #include "driver/uart.h"
 
 #include "r307.h"
+#include "r307_boot.h"
 
 uint8_t esp_chip_id[6];                                     //++ Array to get Chip ID
 char mac_address[20];                                       //++ Array to store Mac Address
@@ -14,16 +15,25 @@ char mac_address[20];                                       //++ Array to store
 char default_address[4] = {0xFF, 0xFF, 0xFF, 0xFF};         //++ Default Module Address is FF:FF:FF:FF
 char default_password[4] = {0x00, 0x00, 0x00, 0x00};        //++ Default Module Password is 00:00:00:00
 
+r307_session_t r307_session;                                //++ Caches handshake & system parameters of the module
+
 void app_main(void)
 {
-    r307_init();                                            //++ Initializing UART for r307 Module
+    uint8_t confirmation_code = 0;
+    r307_session_init(&r307_session, default_address, default_password);
+
+    const r307_boot_config_t boot_config =
+    {
+        .session = &r307_session,
+        .read_template_number = 1,
+    };
+    r307_boot_start(&boot_config);                          //++ Initializing UART & handshaking with r307 Module in background
 
     esp_efuse_mac_get_default(esp_chip_id);
     sprintf(mac_address, "%02x:%02x:%02x:%02x:%02x:%02x", esp_chip_id[0], esp_chip_id[1], esp_chip_id[2], esp_chip_id[3], esp_chip_id[4], esp_chip_id[5]);
     printf("MAC Address is %s\n", mac_address);             //++ Get the MAC Address of current ESP32
     
-    uint8_t confirmation_code = 0;
-    confirmation_code = VfyPwd(default_address, default_password);      //++ Performs Password Verification with Fingerprint Module
+    confirmation_code = r307_boot_wait(10000) ? r307_session_verify(&r307_session) : 0x01;  //++ Answered from the session cache filled by the boot task
 
     if(confirmation_code == 0x00)
     {
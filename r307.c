@@ -2,6 +2,7 @@
 #include "string.h"
 
 #include "esp_log.h"
+#include "esp_timer.h"
 
 #include "driver/uart.h"
 #include "driver/gpio.h"
@@ -12,44 +13,973 @@
 #define RXD_PIN (GPIO_NUM_16)
 
 static const int RX_BUF_SIZE = 2048;            //++ UART RX Buffer Size
+static const int RX_EVENT_QUEUE_SIZE = 16;      //++ UART events waiting to be handled
+static const uint8_t RX_TIMEOUT_SYMBOLS = 3;    //++ Idle time in byte times that ends a burst & raises UART_DATA
 static const char *R307_TX = "R307_TX";         //++ UART RX TAG
 
-void r307_response_parser(char instruction_code[], uint8_t received_package[]);
+#define R307_DATA_TIMEOUT_MS (1000)             //++ Max wait for each Data Package of a transfer
+#define R307_ACK_TIMEOUT_MS (300)               //++ Max wait for an acknowledge beyond the command's own processing time
+#define R307_RX_CHUNK_SIZE (512)                //++ Bytes taken from the UART driver in one read
+#define R307_TIMING_MIN_SAMPLES (8)             //++ Acknowledges measured before the learned deadline replaces the default one
+#define R307_TIMING_MARGIN_MS (50)              //++ Added to average + 4 x deviation ( scheduling & UART jitter )
+#define R307_TIMING_MAX_MS (10000)              //++ Longest learned deadline
+#define R307_TIMING_MIN_PAGES (32)              //++ Fewest searched pages a per-page cost is learned from, below that the fixed overhead dominates
+
+static r307_response_t r307_last_response;      //++ Typed fields of the last received response
+static uint32_t r307_baud_rate = 57600;         //++ UART Baud used by r307_init ( Module Default : 57600 )
+static uint32_t r307_link_generation;           //++ Incremented on every r307_init, module may have lost its state
+static uint8_t r307_retry_budget = 2;           //++ Retries of a command after a link desync
+static uint8_t r307_probe_enabled = 1;          //++ 1 : Send a probe command before every retry
+static uint16_t r307_packet_size = 128;         //++ Data Package size configured in the module ( Module Default : 128 Bytes )
+static r307_link_stats_t link_stats;            //++ Desync & recovery counters
+static r307_transfer_stats_t transfer_stats[4]; //++ Received transfer throughput per Size Code ( 0:32 1:64 2:128 3:256 Bytes )
+static r307_command_timing_t command_timing[R307_TIMING_OPCODES];   //++ Learned acknowledge latency per Instruction Code
+static uart_port_t r307_uart_port = UART_NUM_1; //++ UART of the module commands are sent to
+static r307_char_buffer_t r307_char_buffers[UART_NUM_MAX][2];   //++ Provenance of CharBuffer1 & CharBuffer2 of the module on every port
+static uint32_t r307_char_generation[UART_NUM_MAX];  //++ Link generation the provenance was tracked under
+static uint32_t r307_image_generation;          //++ Incremented whenever ImageBuffer may have changed
+static uint32_t r307_library_generation;        //++ Incremented whenever a library page may have changed
+static void (*r307_acquire_hook)(void);         //++ Link ownership hooks of a scheduler ( r307_set_link_hooks )
+static void (*r307_release_hook)(void);
+static QueueHandle_t r307_uart_queues[UART_NUM_MAX];    //++ UART event queue of every installed port
+static uint8_t rx_chunk[R307_RX_CHUNK_SIZE];    //++ Last burst read from the UART driver, parsed from here
+static int rx_chunk_start;                      //++ Next unparsed byte of rx_chunk
+static int rx_chunk_end;                        //++ End of the valid bytes of rx_chunk
+static char r307_fixed_frames[][R307_FIXED_FRAME_SIZE] =    //++ Commands without Packet Data, sent as they are
+{
+    R307_DEFAULT_FRAME(0x01),                   //++ GenImg
+    R307_DEFAULT_FRAME(0x03),                   //++ Match
+    R307_DEFAULT_FRAME(0x05),                   //++ RegModel
+    R307_DEFAULT_FRAME(0x0A),                   //++ UpImage
+    R307_DEFAULT_FRAME(0x0B),                   //++ DownImage
+    R307_DEFAULT_FRAME(0x0D),                   //++ Empty
+    R307_DEFAULT_FRAME(0x0F),                   //++ ReadSysPara
+    R307_DEFAULT_FRAME(0x14),                   //++ GetRandomCode
+    R307_DEFAULT_FRAME(0x1D),                   //++ TempleteNum
+    R307_DEFAULT_FRAME(0x28),                   //++ GetImageEx
+    R307_DEFAULT_FRAME(0x34),                   //++ GR_Identify
+};
+static char r307_fixed_address[4] = {0xFF, 0xFF, 0xFF, 0xFF};  //++ Module address r307_fixed_frames are built for
+static int r307_port_pins[UART_NUM_MAX][2] =    //++ TX & RX pins of every port r307_init_port installed
+{
+    [UART_NUM_1] = {TXD_PIN, RXD_PIN},
+};
+
+void r307_init(void)                          
+{
+    r307_init_port(r307_uart_port, r307_port_pins[r307_uart_port][0], r307_port_pins[r307_uart_port][1]);
+}
+
+void r307_init_port(uart_port_t uart_port, int tx_pin, int rx_pin)
+{
+    const uart_config_t uart_config = 
+    {
+        .baud_rate = r307_baud_rate,
+        .data_bits = UART_DATA_8_BITS,
+        .parity = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_1,
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+        .source_clk = UART_SCLK_APB,
+    };
+    // We won't use a buffer for sending data.
+    uart_driver_install(uart_port, RX_BUF_SIZE * 2, 0, RX_EVENT_QUEUE_SIZE, &r307_uart_queues[uart_port], 0);
+    uart_param_config(uart_port, &uart_config);
+    uart_set_pin(uart_port, tx_pin, rx_pin, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
+    uart_set_rx_timeout(uart_port, RX_TIMEOUT_SYMBOLS);                                 //++ Pattern detection can't match 0xEF01, the gap after a package ends the burst instead
+    rx_chunk_start = rx_chunk_end = 0;
+    r307_port_pins[uart_port][0] = tx_pin;
+    r307_port_pins[uart_port][1] = rx_pin;
+    r307_uart_port = uart_port;
+    r307_link_generation++;
+}
+
+uart_port_t r307_select_port(uart_port_t uart_port)
+{
+    const uart_port_t previous_port = r307_uart_port;
+
+    r307_uart_port = uart_port;
+    rx_chunk_start = rx_chunk_end = 0;                                                  //++ Bytes of the other port's burst are not ours
+
+    return previous_port;
+}
+
+void r307_deinit(void)
+{
+    const gpio_config_t io_config =
+    {
+        .pin_bit_mask = (1ULL << r307_port_pins[r307_uart_port][0]) | (1ULL << r307_port_pins[r307_uart_port][1]),
+        .mode = GPIO_MODE_DISABLE,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE,
+    };
+
+    uart_driver_delete(r307_uart_port);
+    r307_uart_queues[r307_uart_port] = NULL;                                            //++ Deleted together with the driver
+    rx_chunk_start = rx_chunk_end = 0;
+    gpio_config(&io_config);                                                            //++ Float TX & RX so an unpowered module is not fed through its UART pins
+}
+
+void r307_set_baud_rate(uint32_t baud_rate)
+{
+    r307_baud_rate = baud_rate;
+    uart_set_baudrate(r307_uart_port, baud_rate);                                       //++ Apply now if the driver is installed, else on next r307_init
+}
+
+uint32_t r307_get_baud_rate(void)
+{
+    return r307_baud_rate;
+}
+
+uint32_t r307_get_link_generation(void)
+{
+    return r307_link_generation;
+}
+
+void r307_set_packet_size(uint16_t packet_size)
+{
+    r307_packet_size = packet_size;
+}
+
+uint16_t r307_get_packet_size(void)
+{
+    return r307_packet_size;
+}
+
+static int r307_size_code(uint16_t packet_size)
+{
+    int size_code = 0;
+
+    while(size_code < 3 && (32 << size_code) < packet_size)
+    {
+        size_code++;
+    }
+
+    return size_code;
+}
+
+void r307_flush_input(void)
+{
+    uart_flush_input(r307_uart_port);
+    if(r307_uart_queues[r307_uart_port])
+    {
+        xQueueReset(r307_uart_queues[r307_uart_port]);
+    }
+    rx_chunk_start = rx_chunk_end = 0;
+}
+
+static int r307_rx_fill(TickType_t deadline)
+{
+    QueueHandle_t uart_queue = r307_uart_queues[r307_uart_port];
+    uart_event_t event;
+
+    rx_chunk_start = rx_chunk_end = 0;
+    while(1)
+    {
+        size_t buffered = 0;
+        uart_get_buffered_data_len(r307_uart_port, &buffered);
+        if(buffered > 0)                                                                //++ Take the whole burst in one read
+        {
+            const int rxBytes = uart_read_bytes(r307_uart_port, rx_chunk, buffered < sizeof(rx_chunk) ? buffered : sizeof(rx_chunk), 0);
+            rx_chunk_end = rxBytes > 0 ? rxBytes : 0;
+            return rx_chunk_end;
+        }
+
+        const TickType_t now = xTaskGetTickCount();
+        if((int32_t)(deadline - now) <= 0)
+        {
+            return 0;
+        }
+        if(uart_queue == NULL)                                                          //++ Driver installed around r307_init_port, wait for bytes directly
+        {
+            const int rxBytes = uart_read_bytes(r307_uart_port, rx_chunk, 1, deadline - now);
+            rx_chunk_end = rxBytes > 0 ? rxBytes : 0;
+            return rx_chunk_end;
+        }
+        if(xQueueReceive(uart_queue, &event, deadline - now) != pdTRUE)
+        {
+            return 0;
+        }
+        link_stats.rx_wakeups++;
+        if(event.type == UART_FIFO_OVF || event.type == UART_BUFFER_FULL)               //++ Bytes were lost, the broken package is rejected by length or checksum
+        {
+            link_stats.rx_overflows++;
+            uart_flush_input(r307_uart_port);
+            xQueueReset(uart_queue);
+        }
+    }
+}
+
+static int r307_read_exact(uint8_t data[], int length, TickType_t deadline)
+{
+    int received = 0;
+
+    while(received < length)
+    {
+        if(rx_chunk_start == rx_chunk_end && r307_rx_fill(deadline) <= 0)
+        {
+            break;
+        }
+
+        int chunk = rx_chunk_end - rx_chunk_start;
+        chunk = chunk < length - received ? chunk : length - received;
+        memcpy(data + received, &rx_chunk[rx_chunk_start], chunk);
+        rx_chunk_start += chunk;
+        received = received + chunk;
+    }
+
+    return received;
+}
+
+uint8_t r307_wait_for_byte(uint8_t expected_byte, int timeout_ms)
+{
+    const TickType_t deadline = xTaskGetTickCount() + timeout_ms / portTICK_PERIOD_MS;
+    uint8_t byte = 0;
+
+    while(r307_read_exact(&byte, 1, deadline) == 1)                                     //++ Other bytes ( e.g. noise while powering up ) are dropped
+    {
+        if(byte == expected_byte)
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+r307_rx_status_t r307_read_package(uint8_t received_package[], int package_size, int timeout_ms, int *package_length)
+{
+    const TickType_t deadline = xTaskGetTickCount() + timeout_ms / portTICK_PERIOD_MS;
+    uint8_t previous_byte = 0;
+    int skipped_bytes = -1;
+
+    *package_length = 0;
+    while(1)                                                                            //++ Hunt for the 0xEF01 header, skipping bytes of a broken package
+    {
+        if(r307_read_exact(&received_package[1], 1, deadline) != 1)
+        {
+            link_stats.resync_bytes = link_stats.resync_bytes + (skipped_bytes > 0 ? skipped_bytes : 0);
+            return skipped_bytes > 0 ? R307_RX_BAD_HEADER : R307_RX_TIMEOUT;
+        }
+        skipped_bytes++;
+        if(previous_byte == 0xEF && received_package[1] == 0x01)
+        {
+            break;
+        }
+        previous_byte = received_package[1];
+    }
+    received_package[0] = 0xEF;
+    skipped_bytes--;                                                                    //++ 0xEF belongs to the header
+    link_stats.resync_bytes = link_stats.resync_bytes + skipped_bytes;
+
+    if(r307_read_exact(&received_package[2], 7, deadline) != 7)                         //++ Address, Package Identifier & Package Length
+    {
+        return R307_RX_BAD_LENGTH;
+    }
+
+    const int length = (received_package[7] << 8) | received_package[8];
+    if(length < 3 || length + 9 > package_size)
+    {
+        return R307_RX_BAD_LENGTH;
+    }
+    if(r307_read_exact(&received_package[9], length, deadline) != length)              //++ Dropped bytes leave the package short
+    {
+        return R307_RX_BAD_LENGTH;
+    }
+
+    uint16_t sum = 0;
+    for(int i=6; i<length + 7; i++)                                                     //++ Package Identifier, Package Length & Contents
+    {
+        sum = sum + received_package[i];
+    }
+    if(sum != ((received_package[length + 7] << 8) | received_package[length + 8]))
+    {
+        return R307_RX_BAD_CHECKSUM;
+    }
+
+    *package_length = length + 9;
+    if(skipped_bytes > 0)
+    {
+        ESP_LOGW("R307_RX", "Skipped %d bytes before header", skipped_bytes);
+    }
+
+    return R307_RX_OK;
+}
+
+static uint16_t r307_ack_length(uint8_t instruction_code)
+{
+    switch(instruction_code)                                                            //++ Package Length of a successful acknowledge for each command
+    {
+        case 0x0F: return 0x13;                                                         //++ ReadSysPara : 16 bytes of parameters
+        case 0x1D: return 0x05;                                                         //++ TempleteNum : template number
+        case 0x03: return 0x05;                                                         //++ Match : match score
+        case 0x04: return 0x07;                                                         //++ Search : page id & match score
+        case 0x14: return 0x07;                                                         //++ GetRandomCode : 32-bit number
+        case 0x32: return 0x07;                                                         //++ GR_Auto : page id & match score
+        case 0x34: return 0x07;                                                         //++ GR_Identify : page id & match score
+        case 0x19: return 0x23;                                                         //++ ReadNotepad : 32 bytes of the notepad page
+        case 0x1B: return 0x07;                                                         //++ HighSpeedSearch : page id & match score
+        case 0x1F: return 0x23;                                                         //++ ReadIndexTable : 32 bytes of occupancy bits
+        default: return 0x03;
+    }
+}
+
+static void r307_count_desync(r307_rx_status_t rx_status)
+{
+    link_stats.desyncs++;
+    link_stats.bad_header = link_stats.bad_header + (rx_status == R307_RX_BAD_HEADER);
+    link_stats.bad_checksum = link_stats.bad_checksum + (rx_status == R307_RX_BAD_CHECKSUM);
+    link_stats.bad_pid = link_stats.bad_pid + (rx_status == R307_RX_BAD_PID);
+    link_stats.bad_length = link_stats.bad_length + (rx_status == R307_RX_BAD_LENGTH);
+}
+
+static uint8_t r307_receive_ack(char instruction_code, int timeout_ms)
+{
+    uint8_t received_confirmation_code = 0;
+    uint8_t received_package[R307_MAX_PACKAGE_SIZE];
+    int package_length = 0;
+
+    memset(&r307_last_response, 0, sizeof(r307_last_response));                        //++ Forget the previous response before waiting for a new one
+    r307_last_response.instruction_code = instruction_code;
+
+    r307_rx_status_t rx_status = r307_read_package(received_package, sizeof(received_package), timeout_ms, &package_length);
+    if(rx_status == R307_RX_OK && received_package[6] != 0x07)                          //++ Commands are answered by an acknowledge package only
+    {
+        rx_status = R307_RX_BAD_PID;
+    }
+    if(rx_status == R307_RX_OK && package_length != 12 && package_length != r307_ack_length(instruction_code) + 9)
+    {
+        rx_status = R307_RX_BAD_LENGTH;                                                 //++ Acknowledge belongs to another command
+    }
+    r307_last_response.rx_status = rx_status;
+
+    if(rx_status == R307_RX_OK)
+    {
+        r307_last_response.received = 1;
+        r307_last_response.confirmation_code = received_package[9];
+        ESP_LOG_BUFFER_HEXDUMP("R307_RX", received_package, package_length, ESP_LOG_INFO);  //++ Dumps the response in HEX format
+
+        r307_response_parser(instruction_code, received_package);                       //++ Pass the received response to the parser function
+        received_confirmation_code = received_package[9];                               //++ Get the Confirmation Code from received from the response
+    }
+    else if(rx_status != R307_RX_TIMEOUT)
+    {
+        r307_count_desync(rx_status);
+        ESP_LOGW("R307_RX", "Link desync ( status %d ) on instruction 0x%02X", rx_status, (uint8_t)instruction_code);
+        received_confirmation_code = 0x01;                                              //++ Garbage is not COMMAND EXECUTION COMPLETE either
+    }
+    else
+    {
+        link_stats.timeouts++;
+        received_confirmation_code = R307_TIMEOUT;                                      //++ Silence must not read as 0x00 ( COMMAND EXECUTION COMPLETE )
+    }
+
+    return received_confirmation_code;
+}
+
+uint8_t r307_reponse(char instruction_code)
+{
+    return r307_receive_ack(instruction_code, R307_ACK_TIMEOUT_MS);
+}
+
+static void r307_probe(char tx_cmd_data[])
+{
+    char probe_data[R307_FIXED_FRAME_SIZE] = R307_DEFAULT_FRAME(0x1D);                 //++ TempleteNum, the cheapest command
+    uint8_t received_package[R307_MAX_PACKAGE_SIZE];
+    int package_length = 0;
+
+    memcpy(&probe_data[2], &tx_cmd_data[2], 4);                                         //++ Probe the same module address
+    link_stats.probes++;
+
+    r307_flush_input();
+    uart_write_bytes(r307_uart_port, probe_data, sizeof(probe_data));                   //++ A complete frame realigns the module's receiver after a partial one
+    r307_read_package(received_package, sizeof(received_package), R307_ACK_TIMEOUT_MS, &package_length);
+}
+
+static void r307_sync_char_generation(void)
+{
+    if(r307_char_generation[r307_uart_port] != r307_link_generation)                                   //++ Module may have been power cycled, its buffers are gone
+    {
+        memset(r307_char_buffers[r307_uart_port], 0, sizeof(r307_char_buffers[r307_uart_port]));
+        r307_char_generation[r307_uart_port] = r307_link_generation;
+    }
+}
+
+static void r307_forget_pages(int first_page, int number_of_pages)
+{
+    for(int i=0; i<2; i++)
+    {
+        if(r307_char_buffers[r307_uart_port][i].source == R307_CHAR_PAGE && r307_char_buffers[r307_uart_port][i].page_id >= first_page && r307_char_buffers[r307_uart_port][i].page_id < first_page + number_of_pages)
+        {
+            r307_char_buffers[r307_uart_port][i].source = R307_CHAR_UNKNOWN;
+        }
+    }
+}
+
+static void r307_track_char_buffers(const char tx_cmd_data[], uint8_t confirmation_code)
+{
+    const uint8_t instruction_code = tx_cmd_data[9];
+    const uint8_t answered = (r307_last_response.rx_status == R307_RX_OK);              //++ Broken or missing acknowledge : the command may or may not have run
+    const uint8_t done = answered && confirmation_code == 0x00;
+    const uint8_t unchanged = answered && confirmation_code != 0x00;                    //++ Module answered with an error, nothing was modified
+    const int buffer = ((uint8_t)tx_cmd_data[10] == 0x02) ? 1 : 0;
+    const uint16_t page_id = ((uint8_t)tx_cmd_data[11] << 8) | (uint8_t)tx_cmd_data[12];
+
+    r307_sync_char_generation();
+    switch(instruction_code)
+    {
+        case 0x01:                                                                      //++ GenImg
+        case 0x28:                                                                      //++ GetImageEx
+        case 0x0B:                                                                      //++ DownImage
+            r307_image_generation++;
+            break;
+
+        case 0x02:                                                                      //++ Img2Tz
+            r307_char_buffers[r307_uart_port][buffer].source = done ? R307_CHAR_IMAGE : R307_CHAR_UNKNOWN;
+            r307_char_buffers[r307_uart_port][buffer].image_generation = r307_image_generation;
+            break;
+
+        case 0x05:                                                                      //++ RegModel, result goes to both buffers
+            r307_char_buffers[r307_uart_port][0].source = done ? R307_CHAR_MODEL : R307_CHAR_UNKNOWN;
+            r307_char_buffers[r307_uart_port][1].source = r307_char_buffers[r307_uart_port][0].source;
+            break;
+
+        case 0x06:                                                                      //++ Store
+            if(!unchanged)
+            {
+                r307_forget_pages(page_id, 1);
+                r307_library_generation++;
+            }
+            if(done)
+            {
+                r307_char_buffers[r307_uart_port][buffer].source = R307_CHAR_PAGE;
+                r307_char_buffers[r307_uart_port][buffer].page_id = page_id;
+            }
+            break;
+
+        case 0x07:                                                                      //++ LoadChar
+            r307_char_buffers[r307_uart_port][buffer].source = done ? R307_CHAR_PAGE : R307_CHAR_UNKNOWN;
+            r307_char_buffers[r307_uart_port][buffer].page_id = page_id;
+            break;
+
+        case 0x09:                                                                      //++ DownChar
+            r307_char_buffers[r307_uart_port][buffer].source = done ? R307_CHAR_DOWNLOADED : R307_CHAR_UNKNOWN;
+            break;
+
+        case 0x0C:                                                                      //++ DeletChar
+            if(!unchanged)
+            {
+                r307_forget_pages(((uint8_t)tx_cmd_data[10] << 8) | (uint8_t)tx_cmd_data[11], ((uint8_t)tx_cmd_data[12] << 8) | (uint8_t)tx_cmd_data[13]);
+                r307_library_generation++;
+            }
+            break;
+
+        case 0x0D:                                                                      //++ Empty
+            if(!unchanged)
+            {
+                r307_forget_pages(0, 0x10000);
+                r307_library_generation++;
+            }
+            break;
+
+        case 0x32:                                                                      //++ GR_Auto & GR_Identify use both buffers & ImageBuffer
+        case 0x34:
+            memset(r307_char_buffers[r307_uart_port], 0, sizeof(r307_char_buffers[r307_uart_port]));
+            r307_image_generation++;
+            r307_library_generation += (instruction_code == 0x32);                      //++ GR_Auto stores the enrolled finger
+            break;
+
+        default:
+            break;
+    }
+}
+
+static int r307_learned_deadline_ms(const r307_command_timing_t *timing)
+{
+    const int deadline_ms = (timing->average_us + 4 * timing->deviation_us) / 1000 + R307_TIMING_MARGIN_MS;
+
+    return deadline_ms < R307_TIMING_MAX_MS ? deadline_ms : R307_TIMING_MAX_MS;
+}
+
+static uint8_t r307_answer_time_varies(uint8_t instruction_code)
+{
+    switch(instruction_code)                                                            //++ Latency depends on the finger or the library, not on the link
+    {
+        case 0x01:                                                                      //++ GenImg : No finger is answered at once, a finger after the capture
+        case 0x04:                                                                      //++ Search : No match takes the whole library
+        case 0x1B:                                                                      //++ HighSpeedSearch
+        case 0x28:                                                                      //++ GetImageEx
+        case 0x32:                                                                      //++ GR_Auto
+        case 0x34:                                                                      //++ GR_Identify
+            return 1;
+
+        default:
+            return 0;
+    }
+}
+
+static uint8_t r307_is_search(uint8_t instruction_code)
+{
+    return instruction_code == 0x04 || instruction_code == 0x1B;                        //++ Search & HighSpeedSearch : Buffer ID, Start Page, Page Number
+}
+
+static int r307_searched_pages(const char tx_cmd_data[])
+{
+    return ((uint8_t)tx_cmd_data[13] << 8) | (uint8_t)tx_cmd_data[14];
+}
+
+static int r307_command_deadline_ms(const char tx_cmd_data[], int delay_ms)
+{
+    const uint8_t instruction_code = tx_cmd_data[9];
+    const r307_command_timing_t *timing = &command_timing[instruction_code % R307_TIMING_OPCODES];
+
+    if(instruction_code >= R307_TIMING_OPCODES)
+    {
+        return delay_ms + R307_ACK_TIMEOUT_MS;
+    }
+    if(timing->override_ms)
+    {
+        return timing->override_ms;
+    }
+    if(r307_is_search(instruction_code) && timing->page_cost_us)                        //++ Scales with the pages asked for, a no-match compares all of them
+    {
+        const int64_t deadline_ms = R307_ACK_TIMEOUT_MS + 2 * (int64_t)timing->page_cost_us * r307_searched_pages(tx_cmd_data) / 1000;
+
+        return deadline_ms < R307_TIMING_MAX_MS ? (int)deadline_ms : R307_TIMING_MAX_MS;
+    }
+    if(timing->samples < R307_TIMING_MIN_SAMPLES || r307_answer_time_varies(instruction_code))   //++ Not learned yet or only a statistic, keep the generous default
+    {
+        return delay_ms + R307_ACK_TIMEOUT_MS;
+    }
+
+    return r307_learned_deadline_ms(timing);
+}
+
+static void r307_learn_latency(uint8_t instruction_code, int64_t latency_us)
+{
+    r307_command_timing_t *timing = &command_timing[instruction_code];
+    const int32_t sample_us = latency_us < (int64_t)R307_TIMING_MAX_MS * 1000 ? (int32_t)latency_us : R307_TIMING_MAX_MS * 1000;
+
+    if(timing->samples == 0)
+    {
+        timing->average_us = sample_us;
+        timing->deviation_us = sample_us / 2;
+    }
+    else                                                                                //++ Same estimator as TCP's retransmission timer
+    {
+        const int32_t error_us = sample_us - timing->average_us;
+
+        timing->average_us += error_us / 8;
+        timing->deviation_us += ((error_us < 0 ? -error_us : error_us) - timing->deviation_us) / 4;
+    }
+    timing->samples++;
+}
+
+static void r307_learn_page_cost(const char tx_cmd_data[], uint8_t confirmation_code, int64_t latency_us)
+{
+    const uint8_t instruction_code = tx_cmd_data[9];
+    const int start_page = ((uint8_t)tx_cmd_data[11] << 8) | (uint8_t)tx_cmd_data[12];
+    r307_command_timing_t *timing = &command_timing[instruction_code % R307_TIMING_OPCODES];
+    int pages = 0;
+
+    if(!r307_is_search(instruction_code))
+    {
+        return;
+    }
+    if(confirmation_code == 0x09)
+    {
+        pages = r307_searched_pages(tx_cmd_data);                                       //++ No match : every page was compared
+    }
+    else if(confirmation_code == 0x00 && instruction_code == 0x04 && r307_last_response.page_id >= start_page)
+    {
+        pages = r307_last_response.page_id - start_page + 1;                            //++ Search compares in page order & stops at the match
+    }
+    if(pages < R307_TIMING_MIN_PAGES)
+    {
+        return;
+    }
+
+    const int64_t cost_us = (latency_us + pages - 1) / pages;
+    if(cost_us > timing->page_cost_us)                                                  //++ Slowest cost seen, a deadline must hold for a no-match
+    {
+        timing->page_cost_us = cost_us < 0xFFFF ? (uint16_t)cost_us : 0xFFFF;
+    }
+}
+
+static uint8_t r307_transact_locked(char tx_cmd_data[], int package_length, int delay_ms)
+{
+    const char instruction_code = tx_cmd_data[9];
+    const uint8_t learned = (uint8_t)instruction_code < R307_TIMING_OPCODES;
+    uint8_t confirmation_code = 0;
+
+    link_stats.commands++;
+    for(int attempt=0; attempt<=r307_retry_budget; attempt++)
+    {
+        if(attempt > 0)
+        {
+            link_stats.retries++;
+            if(r307_probe_enabled)
+            {
+                r307_probe(tx_cmd_data);
+            }
+        }
+
+        r307_flush_input();                                                             //++ Stale or partial replies of earlier commands must not be read as ours
+        const int txBytes = uart_write_bytes(r307_uart_port, tx_cmd_data, package_length);  //++ Send entire packet over UART
+        ESP_LOGI(R307_TX, "Wrote %d bytes", txBytes);
+        ESP_LOG_BUFFER_HEXDUMP("R307_TX", tx_cmd_data, package_length, ESP_LOG_DEBUG);
+
+        const int deadline_ms = r307_command_deadline_ms(tx_cmd_data, delay_ms);
+        const int64_t sent_time = esp_timer_get_time();
+        confirmation_code = r307_receive_ack(instruction_code, deadline_ms);           //++ Woken by the UART as soon as the acknowledge is in, not after a fixed delay
+        const int64_t latency_us = esp_timer_get_time() - sent_time;
+
+        if(learned && r307_last_response.rx_status == R307_RX_OK)
+        {
+            r307_learn_latency(instruction_code, latency_us);
+            r307_learn_page_cost(tx_cmd_data, confirmation_code, latency_us);
+        }
+        else if(learned && r307_last_response.rx_status == R307_RX_TIMEOUT && !command_timing[(uint8_t)instruction_code].override_ms && r307_is_search(instruction_code) && command_timing[(uint8_t)instruction_code].page_cost_us)
+        {
+            command_timing[(uint8_t)instruction_code].timeouts++;                       //++ Page cost was too low or module is gone, double it for the next Search
+            command_timing[(uint8_t)instruction_code].page_cost_us = command_timing[(uint8_t)instruction_code].page_cost_us < 0x8000 ? command_timing[(uint8_t)instruction_code].page_cost_us * 2 : 0xFFFF;
+        }
+        else if(learned && r307_last_response.rx_status == R307_RX_TIMEOUT && !command_timing[(uint8_t)instruction_code].override_ms && command_timing[(uint8_t)instruction_code].samples >= R307_TIMING_MIN_SAMPLES && !r307_answer_time_varies(instruction_code))
+        {
+            command_timing[(uint8_t)instruction_code].timeouts++;                       //++ Deadline was too tight or module is gone, widen it for the next command
+            r307_learn_latency(instruction_code, (int64_t)deadline_ms * 2000);
+        }
+
+        if(r307_last_response.rx_status == R307_RX_OK)
+        {
+            link_stats.recoveries = link_stats.recoveries + (attempt > 0);
+            r307_track_char_buffers(tx_cmd_data, confirmation_code);
+            return confirmation_code;
+        }
+        if(r307_last_response.rx_status == R307_RX_TIMEOUT)                             //++ Silence is not a desync, nothing to resynchronize
+        {
+            r307_track_char_buffers(tx_cmd_data, confirmation_code);
+            return confirmation_code;
+        }
+    }
+
+    link_stats.failures++;
+    ESP_LOGE(R307_TX, "Instruction 0x%02X failed after %d retries", (uint8_t)instruction_code, r307_retry_budget);
+    r307_flush_input();
+    r307_track_char_buffers(tx_cmd_data, 0x01);
+
+    return 0x01;                                                                        //++ Same meaning as the module's own ERROR RECEIVING PACKAGE
+}
+
+uint8_t r307_transact(char tx_cmd_data[], int package_length, int delay_ms)
+{
+    uint8_t confirmation_code = 0;
+
+    r307_link_acquire();                                                                //++ Frames of different tasks must never interleave
+    confirmation_code = r307_transact_locked(tx_cmd_data, package_length, delay_ms);
+    r307_link_release();
+
+    return confirmation_code;
+}
+
+static char *r307_fixed_frame(char r307_address[], char instruction_code)
+{
+    if(memcmp(r307_fixed_address, r307_address, 4) != 0)                              //++ SetAdder or another module, patch every frame once ( the checksum does not cover the address )
+    {
+        memcpy(r307_fixed_address, r307_address, 4);
+        for(int i=0; i<sizeof(r307_fixed_frames) / R307_FIXED_FRAME_SIZE; i++)
+        {
+            memcpy(&r307_fixed_frames[i][2], r307_address, 4);
+        }
+        link_stats.frame_rebuilds++;
+    }
+
+    for(int i=0; i<sizeof(r307_fixed_frames) / R307_FIXED_FRAME_SIZE; i++)
+    {
+        if(r307_fixed_frames[i][9] == instruction_code)
+        {
+            return r307_fixed_frames[i];
+        }
+    }
+
+    return NULL;
+}
+
+static uint8_t r307_transact_fixed(char r307_address[], char instruction_code, int delay_ms)
+{
+    uint8_t confirmation_code = 0;
+
+    r307_link_acquire();                                                                //++ Shared frames must not be patched for another address mid command
+    confirmation_code = r307_transact_locked(r307_fixed_frame(r307_address, instruction_code), R307_FIXED_FRAME_SIZE, delay_ms);
+    r307_link_release();
+
+    return confirmation_code;
+}
+
+void r307_set_link_hooks(void (*acquire)(void), void (*release)(void))
+{
+    r307_acquire_hook = acquire;
+    r307_release_hook = release;
+}
+
+void r307_link_acquire(void)
+{
+    if(r307_acquire_hook)
+    {
+        r307_acquire_hook();
+    }
+}
+
+void r307_link_release(void)
+{
+    if(r307_release_hook)
+    {
+        r307_release_hook();
+    }
+}
+
+uint8_t r307_receive_data(r307_data_cb_t callback, void *arg)
+{
+    uint8_t received_package[R307_MAX_PACKAGE_SIZE];
+    r307_transfer_stats_t *stats = &transfer_stats[r307_size_code(r307_packet_size)];
+    const int64_t start_time = esp_timer_get_time();
+    int package_length = 0;
+    uint32_t bytes = 0;
+
+    while(1)
+    {
+        r307_rx_status_t rx_status = r307_read_package(received_package, sizeof(received_package), R307_DATA_TIMEOUT_MS, &package_length);
+        if(rx_status == R307_RX_OK && received_package[6] != 0x02 && received_package[6] != 0x08)
+        {
+            rx_status = R307_RX_BAD_PID;                                                //++ Only Data ( 0x02 ) & End of Data ( 0x08 ) packages may follow
+        }
+        if(rx_status != R307_RX_OK)
+        {
+            if(rx_status == R307_RX_TIMEOUT)
+            {
+                link_stats.timeouts++;
+            }
+            else
+            {
+                r307_count_desync(rx_status);
+            }
+            ESP_LOGE("R307_RX", "Data transfer broken ( status %d )", rx_status);
+            r307_flush_input();
+            return (rx_status == R307_RX_TIMEOUT) ? R307_TIMEOUT : 0x01;
+        }
 
-void r307_init(void)                          
+        if(callback != NULL && callback(&received_package[9], package_length - 11, arg) != 0)    //++ Contents only, without header & checksum
+        {
+            r307_flush_input();                                                         //++ Caller aborted, drop the rest of the transfer
+            return 0x01;
+        }
+
+        bytes += package_length - 11;
+        if(received_package[6] == 0x08)
+        {
+            stats->transfers++;
+            stats->bytes += bytes;
+            stats->time_us += esp_timer_get_time() - start_time;
+            return 0x00;
+        }
+    }
+}
+
+void r307_data_writer_begin(r307_data_writer_t *writer, char r307_address[], int total_length)
 {
-    const uart_config_t uart_config = 
+    writer->package[0] = 0xEF;
+    writer->package[1] = 0x01;
+    memcpy(&writer->package[2], r307_address, 4);
+    writer->fill = 0;
+    writer->remaining = total_length;
+    writer->packet_size = r307_packet_size;
+}
+
+static void r307_data_writer_flush(r307_data_writer_t *writer)
+{
+    const int length = writer->fill + 2;
+    uint16_t sum = 0;
+
+    writer->package[6] = writer->remaining > 0 ? 0x02 : 0x08;                          //++ Last package of the transfer is End of Data
+    writer->package[7] = (length >> 8) & 0xFF;
+    writer->package[8] = length & 0xFF;
+    for(int i=6; i<writer->fill + 9; i++)
     {
-        .baud_rate = 57600,
-        .data_bits = UART_DATA_8_BITS,
-        .parity = UART_PARITY_DISABLE,
-        .stop_bits = UART_STOP_BITS_1,
-        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
-        .source_clk = UART_SCLK_APB,
-    };
-    // We won't use a buffer for sending data.
-    uart_driver_install(UART_NUM_1, RX_BUF_SIZE * 2, 0, 0, NULL, 0);
-    uart_param_config(UART_NUM_1, &uart_config);
-    uart_set_pin(UART_NUM_1, TXD_PIN, RXD_PIN, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
+        sum = sum + writer->package[i];
+    }
+    writer->package[writer->fill + 9] = (sum >> 8) & 0xFF;
+    writer->package[writer->fill + 10] = sum & 0xFF;
+
+    uart_write_bytes(r307_uart_port, (const char *)writer->package, writer->fill + 11);
+    writer->fill = 0;
 }
 
-uint8_t r307_reponse(char instruction_code[])
+int r307_data_writer_write(const uint8_t data[], int length, void *arg)
 {
-    uint8_t received_confirmation_code = 0;
-    uint8_t *received_package = (uint8_t *)malloc(RX_BUF_SIZE + 1);
-    const int rxBytes = uart_read_bytes(UART_NUM_1, received_package, RX_BUF_SIZE, 300 / portTICK_RATE_MS);
-    if (rxBytes > 0)
+    r307_data_writer_t *writer = (r307_data_writer_t *)arg;
+
+    if(length > writer->remaining)
     {
-        received_package[rxBytes] = 0;
-        // ESP_LOGI("R307_RX", "Read %d bytes: '%s'", rxBytes, received_package);
-        ESP_LOG_BUFFER_HEXDUMP("R307_RX", received_package, rxBytes, ESP_LOG_INFO);     //++ Dumps the response in HEX format
+        return 1;                                                                       //++ More bytes than announced
+    }
 
-        r307_response_parser(instruction_code, received_package);                       //++ Pass the received response to the parser function
-        received_confirmation_code = received_package[9];                               //++ Get the Confirmation Code from received from the response
+    while(length > 0)
+    {
+        int chunk = writer->packet_size - writer->fill;
+        chunk = chunk < length ? chunk : length;
+        memcpy(&writer->package[9 + writer->fill], data, chunk);
+        writer->fill += chunk;
+        writer->remaining -= chunk;
+        data += chunk;
+        length -= chunk;
+
+        if(writer->fill == writer->packet_size || writer->remaining == 0)
+        {
+            r307_data_writer_flush(writer);
+        }
     }
-    free(received_package);
 
-    return received_confirmation_code;
+    return 0;
+}
+
+void r307_data_writer_pad(r307_data_writer_t *writer)
+{
+    const uint8_t zeros[32] = {0};
+
+    while(writer->remaining > 0)
+    {
+        r307_data_writer_write(zeros, writer->remaining < (int)sizeof(zeros) ? writer->remaining : (int)sizeof(zeros), writer);
+    }
+}
+
+uint8_t r307_send_data(char r307_address[], const uint8_t data[], int length)
+{
+    r307_data_writer_t writer;
+
+    r307_data_writer_begin(&writer, r307_address, length);
+    return r307_data_writer_write(data, length, &writer) == 0 ? 0x00 : 0x01;
+}
+
+void r307_set_retry_budget(uint8_t retry_budget, uint8_t probe_enabled)
+{
+    r307_retry_budget = retry_budget;
+    r307_probe_enabled = probe_enabled;
+}
+
+void r307_get_link_stats(r307_link_stats_t *stats)
+{
+    memcpy(stats, &link_stats, sizeof(*stats));
+}
+
+void r307_reset_link_stats(void)
+{
+    memset(&link_stats, 0, sizeof(link_stats));
+    memset(transfer_stats, 0, sizeof(transfer_stats));
+}
+
+void r307_set_command_timeout(uint8_t instruction_code, uint16_t timeout_ms)
+{
+    if(instruction_code < R307_TIMING_OPCODES)
+    {
+        command_timing[instruction_code].override_ms = timeout_ms;
+    }
+}
+
+void r307_get_command_timing(uint8_t instruction_code, r307_command_timing_t *timing)
+{
+    memset(timing, 0, sizeof(*timing));
+    if(instruction_code < R307_TIMING_OPCODES)
+    {
+        memcpy(timing, &command_timing[instruction_code], sizeof(*timing));
+        timing->deadline_ms = (timing->samples >= R307_TIMING_MIN_SAMPLES && !r307_answer_time_varies(instruction_code)) ? r307_learned_deadline_ms(timing) : 0;
+        timing->deadline_ms = timing->override_ms ? timing->override_ms : timing->deadline_ms;   //++ 0 : Default deadline of the command
+    }
+}
+
+void r307_set_command_timing(uint8_t instruction_code, const r307_command_timing_t *timing)
+{
+    if(instruction_code < R307_TIMING_OPCODES)
+    {
+        command_timing[instruction_code].samples = timing->samples;
+        command_timing[instruction_code].average_us = timing->average_us;
+        command_timing[instruction_code].deviation_us = timing->deviation_us;
+        command_timing[instruction_code].page_cost_us = timing->page_cost_us;
+    }
+}
+
+void r307_reset_command_timing(void)
+{
+    for(int i=0; i<R307_TIMING_OPCODES; i++)
+    {
+        const uint16_t override_ms = command_timing[i].override_ms;
+
+        memset(&command_timing[i], 0, sizeof(command_timing[i]));
+        command_timing[i].override_ms = override_ms;
+    }
+}
+
+void r307_get_transfer_stats(uint16_t packet_size, r307_transfer_stats_t *stats)
+{
+    memcpy(stats, &transfer_stats[r307_size_code(packet_size)], sizeof(*stats));
+}
+
+void r307_get_char_buffer(char buffer_id, r307_char_buffer_t *state)
+{
+    r307_sync_char_generation();
+    memcpy(state, &r307_char_buffers[r307_uart_port][(buffer_id == 0x02) ? 1 : 0], sizeof(*state));
+}
+
+void r307_invalidate_char_buffers(void)
+{
+    memset(r307_char_buffers[r307_uart_port], 0, sizeof(r307_char_buffers[r307_uart_port]));
+    r307_image_generation++;
+    r307_library_generation++;                                                          //++ Commands around the driver may have changed the library too
+}
+
+uint32_t r307_get_library_generation(void)
+{
+    return r307_library_generation;
+}
+
+static uint8_t r307_skip_command(char instruction_code)
+{
+    memset(&r307_last_response, 0, sizeof(r307_last_response));                        //++ Look like an answered command to callers checking received
+    r307_last_response.received = 1;
+    r307_last_response.instruction_code = instruction_code;
+    link_stats.saved_round_trips++;
+
+    return 0x00;
+}
+
+uint8_t r307_load_char_cached(char r307_address[], char buffer_id[], char page_id[])
+{
+    r307_char_buffer_t state;
+
+    r307_get_char_buffer(buffer_id[0], &state);
+    if(state.source == R307_CHAR_PAGE && state.page_id == ((((uint8_t)page_id[0]) << 8) | (uint8_t)page_id[1]))
+    {
+        return r307_skip_command(0x07);
+    }
+
+    return LoadChar(r307_address, buffer_id, page_id);
+}
+
+uint8_t r307_img2tz_cached(char r307_address[], char buffer_id[])
+{
+    r307_char_buffer_t state;
+
+    r307_get_char_buffer(buffer_id[0], &state);
+    if(state.source == R307_CHAR_IMAGE && state.image_generation == r307_image_generation)
+    {
+        return r307_skip_command(0x02);
+    }
+
+    return Img2Tz(r307_address, buffer_id);
+}
+
+const r307_response_t *r307_get_response(void)
+{
+    return &r307_last_response;
 }
 
 uint16_t check_sum(char tx_cmd_data[], char r307_data[])
@@ -85,6 +1015,30 @@ uint16_t check_sum(char tx_cmd_data[], char r307_data[])
     return result;
 }
 
+int r307_build_command(char tx_cmd_data[], char r307_address[], char instruction_code, const char packet_data[], int data_length)
+{
+    const int package_length = data_length + 3;                                         //++ Instruction Code, Packet Data & Checksum
+    uint16_t checksum_value = 0;
+
+    tx_cmd_data[0] = 0xEF;
+    tx_cmd_data[1] = 0x01;
+    memcpy(&tx_cmd_data[2], r307_address, 4);
+    tx_cmd_data[6] = 0x01;                                                              //++ Package Identifier : Command
+    tx_cmd_data[7] = (package_length >> 8) & 0xFF;
+    tx_cmd_data[8] = package_length & 0xFF;
+    tx_cmd_data[9] = instruction_code;
+    memcpy(&tx_cmd_data[10], packet_data, data_length);
+
+    for(int i=6; i<data_length + 10; i++)                                               //++ Package Identifier, Package Length, Instruction Code & Packet Data
+    {
+        checksum_value = checksum_value + (uint8_t)tx_cmd_data[i];
+    }
+    tx_cmd_data[data_length + 10] = (checksum_value >> 8) & 0xFF;
+    tx_cmd_data[data_length + 11] = checksum_value & 0xFF;
+
+    return data_length + 12;
+}
+
 uint8_t VfyPwd(char r307_address[], char vfy_password[])
 {
     char tx_cmd_data[16] = {0xEF, 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 0x00, 0x07, 0x13};
@@ -105,17 +1059,7 @@ uint8_t VfyPwd(char r307_address[], char vfy_password[])
         }
     }
 
-    char instruction_code;
-
-    instruction_code = tx_cmd_data[9];                                                  //++ Get the Instruction Code
-
-    const int package_length = sizeof(tx_cmd_data);
-    const int txBytes = uart_write_bytes(UART_NUM_1, tx_cmd_data, package_length);      //++ Send entire packet over UART
-
-    ESP_LOGI(R307_TX, "Wrote %d bytes", txBytes);
-    vTaskDelay(500 / portTICK_PERIOD_MS);
-
-    confirmation_code = r307_reponse(instruction_code);
+    confirmation_code = r307_transact(tx_cmd_data, sizeof(tx_cmd_data), 500);
 
     return confirmation_code;
 }
@@ -140,17 +1084,7 @@ uint8_t SetPwd(char r307_address[], char new_password[])
         }
     }
     
-    char instruction_code;
-
-    instruction_code = tx_cmd_data[9];
-
-    const int package_length = sizeof(tx_cmd_data);
-    const int txBytes = uart_write_bytes(UART_NUM_1, tx_cmd_data, package_length);
-
-    ESP_LOGI(R307_TX, "Wrote %d bytes", txBytes);
-    vTaskDelay(500 / portTICK_PERIOD_MS);
-
-    confirmation_code = r307_reponse(instruction_code);
+    confirmation_code = r307_transact(tx_cmd_data, sizeof(tx_cmd_data), 500);
 
     return confirmation_code;
 }
@@ -175,116 +1109,36 @@ uint8_t SetAdder(char r307_address[], char new_address[])
         }
     }
     
-    char instruction_code;
-
-    instruction_code = tx_cmd_data[9];
-
-    const int package_length = sizeof(tx_cmd_data);
-    const int txBytes = uart_write_bytes(UART_NUM_1, tx_cmd_data, package_length);
-    ESP_LOGI(R307_TX, "Wrote %d bytes", txBytes);
-    vTaskDelay(500 / portTICK_PERIOD_MS);
-
-    confirmation_code = r307_reponse(instruction_code);
+    confirmation_code = r307_transact(tx_cmd_data, sizeof(tx_cmd_data), 500);
 
     return confirmation_code;
 }
 
 uint8_t PortControl(char r307_address[], char control_code[])
 {
-    char tx_cmd_data[13] = {0xEF, 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 0x00, 0x04, 0x17};
-    char check_sum_data[2] = {0x00, 0x00};
+    char tx_cmd_data[13];
     uint8_t confirmation_code = 0;
 
-    uint16_t checksum_value = check_sum(tx_cmd_data, control_code);
-    check_sum_data[0] = (checksum_value >> 8) & (0xFF);
-    check_sum_data[1] = checksum_value & (0xFF);
-
-    tx_cmd_data[10] = control_code[0];
-    for(int i=0; i<4; i++)
-    {
-        tx_cmd_data[i+2] = r307_address[i];
-        if(i<2)
-        {
-            tx_cmd_data[i+11] = check_sum_data[i];
-        }
-    }
-    
-    char instruction_code;
-
-    instruction_code = tx_cmd_data[9];
-
-    const int package_length = sizeof(tx_cmd_data);
-    const int txBytes = uart_write_bytes(UART_NUM_1, tx_cmd_data, package_length);
-    ESP_LOGI(R307_TX, "Wrote %d bytes", txBytes);
-    vTaskDelay(500 / portTICK_PERIOD_MS);
-
-    confirmation_code = r307_reponse(instruction_code);
+    const int package_length = r307_build_command(tx_cmd_data, r307_address, 0x17, control_code, 1);
+    confirmation_code = r307_transact(tx_cmd_data, package_length, 500);
 
     return confirmation_code;
 }
 
 uint8_t ReadSysPara(char r307_address[])
 {
-    char tx_cmd_data[12] = {0xEF, 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 0x00, 0x03, 0x0F, 0x00, 0x13};
-    char check_sum_data[2] = {0x00, 0x00};
     uint8_t confirmation_code = 0;
 
-    uint16_t checksum_value = check_sum(tx_cmd_data, "#12");
-    check_sum_data[0] = (checksum_value >> 8) & (0xFF);
-    check_sum_data[1] = checksum_value & (0xFF);
-
-    for(int i=0; i<4; i++)
-    {
-        tx_cmd_data[i+2] = r307_address[i];
-        if(i<2)
-        {
-            tx_cmd_data[i+10] = check_sum_data[i];
-        }
-    }
-    
-    char instruction_code;
-
-    instruction_code = tx_cmd_data[9];
-
-    const int package_length = sizeof(tx_cmd_data);
-    const int txBytes = uart_write_bytes(UART_NUM_1, tx_cmd_data, package_length);
-    ESP_LOGI(R307_TX, "Wrote %d bytes", txBytes);
-    vTaskDelay(500 / portTICK_PERIOD_MS);
-
-    confirmation_code = r307_reponse(instruction_code);
+    confirmation_code = r307_transact_fixed(r307_address, 0x0F, 500);
 
     return confirmation_code;
 }
 
 uint8_t TempleteNum(char r307_address[])
 {
-    char tx_cmd_data[12] = {0xEF, 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 0x00, 0x03, 0x1D, 0x00, 0x21};
-    char check_sum_data[2] = {0x00, 0x00};
     uint8_t confirmation_code = 0;
 
-    uint16_t checksum_value = check_sum(tx_cmd_data, "#12");
-    check_sum_data[0] = (checksum_value >> 8) & (0xFF);
-    check_sum_data[1] = checksum_value & (0xFF);
-
-    for(int i=0; i<4; i++)
-    {
-        tx_cmd_data[i+2] = r307_address[i];
-        if(i<2)
-        {
-            tx_cmd_data[i+10] = check_sum_data[i];
-        }
-    }
-    
-    char instruction_code;
-
-    instruction_code = tx_cmd_data[9];
-
-    const int package_length = sizeof(tx_cmd_data);
-    const int txBytes = uart_write_bytes(UART_NUM_1, tx_cmd_data, package_length);
-    ESP_LOGI(R307_TX, "Wrote %d bytes", txBytes);
-    vTaskDelay(500 / portTICK_PERIOD_MS);
-
-    confirmation_code = r307_reponse(instruction_code);
+    confirmation_code = r307_transact_fixed(r307_address, 0x1D, 500);
 
     return confirmation_code;
 }
@@ -308,557 +1162,312 @@ uint8_t GR_Auto(char r307_address[])
         }
     }
     
-    char instruction_code;
-
-    instruction_code = tx_cmd_data[9];
-
-    const int package_length = sizeof(tx_cmd_data);
-    const int txBytes = uart_write_bytes(UART_NUM_1, tx_cmd_data, package_length);
-    ESP_LOGI(R307_TX, "Wrote %d bytes", txBytes);
-    vTaskDelay(500 / portTICK_PERIOD_MS);
-
-    confirmation_code = r307_reponse(instruction_code);
+    confirmation_code = r307_transact(tx_cmd_data, sizeof(tx_cmd_data), 500);
 
     return confirmation_code;
 }
 
 uint8_t GR_Identify(char r307_address[])
 {
-    char tx_cmd_data[12] = {0xEF, 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 0x00, 0x03, 0x34};
-    char check_sum_data[2] = {0x00, 0x00};
     uint8_t confirmation_code = 0;
 
-    uint16_t checksum_value = check_sum(tx_cmd_data, "#12");
-    check_sum_data[0] = (checksum_value >> 8) & (0xFF);
-    check_sum_data[1] = checksum_value & (0xFF);
-
-    for(int i=0; i<4; i++)
-    {
-        tx_cmd_data[i+2] = r307_address[i];
-        if(i<2)
-        {
-            tx_cmd_data[i+10] = check_sum_data[i];
-        }
-    }
-    
-    char instruction_code;
-
-    instruction_code = tx_cmd_data[9];
-
-    const int package_length = sizeof(tx_cmd_data);
-    const int txBytes = uart_write_bytes(UART_NUM_1, tx_cmd_data, package_length);
-    ESP_LOGI(R307_TX, "Wrote %d bytes", txBytes);
-    vTaskDelay(500 / portTICK_PERIOD_MS);
-
-    confirmation_code = r307_reponse(instruction_code);
+    confirmation_code = r307_transact_fixed(r307_address, 0x34, 500);
 
     return confirmation_code;
 }
 
 uint8_t GenImg(char r307_address[])
 {
-    char tx_cmd_data[12] = {0xEF, 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 0x00, 0x03, 0x01};
-    char check_sum_data[2] = {0x00, 0x00};
     uint8_t confirmation_code = 0;
 
-    uint16_t checksum_value = check_sum(tx_cmd_data, "#12");
-    check_sum_data[0] = (checksum_value >> 8) & (0xFF);
-    check_sum_data[1] = checksum_value & (0xFF);
-
-    for(int i=0; i<4; i++)
-    {
-        tx_cmd_data[i+2] = r307_address[i];
-        if(i<2)
-        {
-            tx_cmd_data[i+10] = check_sum_data[i];
-        }
-    }
-    
-    char instruction_code;
-
-    instruction_code = tx_cmd_data[9];
-
-    const int package_length = sizeof(tx_cmd_data);
-    const int txBytes = uart_write_bytes(UART_NUM_1, tx_cmd_data, package_length);
-    ESP_LOGI(R307_TX, "Wrote %d bytes", txBytes);
-    vTaskDelay(1000 / portTICK_PERIOD_MS);
-
-    confirmation_code = r307_reponse(instruction_code);
+    confirmation_code = r307_transact_fixed(r307_address, 0x01, 1000);
 
     return confirmation_code;
 }
 
 uint8_t UpImage(char r307_address[])
 {
-    char tx_cmd_data[12] = {0xEF, 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 0x00, 0x03, 0x0A};
-    char check_sum_data[2] = {0x00, 0x00};
     uint8_t confirmation_code = 0;
 
-    uint16_t checksum_value = check_sum(tx_cmd_data, "#12");
-    check_sum_data[0] = (checksum_value >> 8) & (0xFF);
-    check_sum_data[1] = checksum_value & (0xFF);
-
-    for(int i=0; i<4; i++)
-    {
-        tx_cmd_data[i+2] = r307_address[i];
-        if(i<2)
-        {
-            tx_cmd_data[i+10] = check_sum_data[i];
-        }
-    }
-    
-    char instruction_code;
-
-    instruction_code = tx_cmd_data[9];
-
-    const int package_length = sizeof(tx_cmd_data);
-    const int txBytes = uart_write_bytes(UART_NUM_1, tx_cmd_data, package_length);
-    ESP_LOGI(R307_TX, "Wrote %d bytes", txBytes);
-    vTaskDelay(2000 / portTICK_PERIOD_MS);
-
-    confirmation_code = r307_reponse(instruction_code);
+    confirmation_code = r307_transact_fixed(r307_address, 0x0A, 2000);
 
     return confirmation_code;
 }
 
-uint8_t DownImage(char r307_address[])
+uint8_t r307_up_image(char r307_address[], r307_data_cb_t callback, void *arg)
 {
-    char tx_cmd_data[12] = {0xEF, 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 0x00, 0x03, 0x0B};
-    char check_sum_data[2] = {0x00, 0x00};
     uint8_t confirmation_code = 0;
 
-    uint16_t checksum_value = check_sum(tx_cmd_data, "#12");
-    check_sum_data[0] = (checksum_value >> 8) & (0xFF);
-    check_sum_data[1] = checksum_value & (0xFF);
-
-    for(int i=0; i<4; i++)
+    r307_link_acquire();                                                                //++ Acknowledge & Data Packages form one exchange
+    confirmation_code = r307_transact_fixed(r307_address, 0x0A, 0);                     //++ No delay, Data Packages follow the acknowledge immediately
+    if(confirmation_code == 0x00 && r307_last_response.received)
     {
-        tx_cmd_data[i+2] = r307_address[i];
-        if(i<2)
-        {
-            tx_cmd_data[i+10] = check_sum_data[i];
-        }
+        confirmation_code = r307_receive_data(callback, arg);
     }
-    
-    char instruction_code;
-
-    instruction_code = tx_cmd_data[9];
-
-    const int package_length = sizeof(tx_cmd_data);
-    const int txBytes = uart_write_bytes(UART_NUM_1, tx_cmd_data, package_length);
-    ESP_LOGI(R307_TX, "Wrote %d bytes", txBytes);
-    vTaskDelay(1000 / portTICK_PERIOD_MS);
-
-    confirmation_code = r307_reponse(instruction_code);
+    r307_link_release();
 
     return confirmation_code;
-}
-
-uint8_t Img2Tz(char r307_address[], char buffer_id[])
-{
-    char tx_cmd_data[13] = {0xEF, 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 0x00, 0x04, 0x02};
-    char check_sum_data[2] = {0x00, 0x00};
-    uint8_t confirmation_code = 0;
-
-    uint16_t checksum_value = check_sum(tx_cmd_data, buffer_id);
-    check_sum_data[0] = (checksum_value >> 8) & (0xFF);
-    check_sum_data[1] = checksum_value & (0xFF);
-
-    tx_cmd_data[10] = buffer_id[0];
-    for(int i=0; i<4; i++)
-    {
-        tx_cmd_data[i+2] = r307_address[i];
-        if(i<2)
-        {
-            tx_cmd_data[i+11] = check_sum_data[i];
-        }
-    }
-    
-    char instruction_code;
-
-    instruction_code = tx_cmd_data[9];
+}
 
-    const int package_length = sizeof(tx_cmd_data);
-    const int txBytes = uart_write_bytes(UART_NUM_1, tx_cmd_data, package_length);
-    ESP_LOGI(R307_TX, "Wrote %d bytes", txBytes);
-    vTaskDelay(1000 / portTICK_PERIOD_MS);
+uint8_t DownImage(char r307_address[])
+{
+    uint8_t confirmation_code = 0;
 
-    confirmation_code = r307_reponse(instruction_code);
+    confirmation_code = r307_transact_fixed(r307_address, 0x0B, 1000);
 
     return confirmation_code;
 }
 
-uint8_t RegModel(char r307_address[])
+uint8_t r307_down_image(char r307_address[], r307_data_writer_t *writer)
 {
-    char tx_cmd_data[12] = {0xEF, 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 0x00, 0x03, 0x05};
-    char check_sum_data[2] = {0x00, 0x00};
     uint8_t confirmation_code = 0;
 
-    uint16_t checksum_value = check_sum(tx_cmd_data, "#12");
-    check_sum_data[0] = (checksum_value >> 8) & (0xFF);
-    check_sum_data[1] = checksum_value & (0xFF);
-
-    for(int i=0; i<4; i++)
+    confirmation_code = r307_transact_fixed(r307_address, 0x0B, 0);                     //++ Module waits for the Data Packages right after its acknowledge
+    if(confirmation_code == 0x00 && r307_last_response.received)
     {
-        tx_cmd_data[i+2] = r307_address[i];
-        if(i<2)
-        {
-            tx_cmd_data[i+10] = check_sum_data[i];
-        }
+        r307_data_writer_begin(writer, r307_address, R307_IMAGE_SIZE);
     }
-    
-    char instruction_code;
 
-    instruction_code = tx_cmd_data[9];
+    return confirmation_code;
+}
 
-    const int package_length = sizeof(tx_cmd_data);
-    const int txBytes = uart_write_bytes(UART_NUM_1, tx_cmd_data, package_length);
-    ESP_LOGI(R307_TX, "Wrote %d bytes", txBytes);
-    vTaskDelay(1000 / portTICK_PERIOD_MS);
+uint8_t Img2Tz(char r307_address[], char buffer_id[])
+{
+    char tx_cmd_data[13];
+    uint8_t confirmation_code = 0;
 
-    confirmation_code = r307_reponse(instruction_code);
+    const int package_length = r307_build_command(tx_cmd_data, r307_address, 0x02, buffer_id, 1);
+    confirmation_code = r307_transact(tx_cmd_data, package_length, 1000);
 
     return confirmation_code;
 }
 
-uint8_t UpChar(char r307_address[], char buffer_id[])
+uint8_t RegModel(char r307_address[])
 {
-    char tx_cmd_data[13] = {0xEF, 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 0x00, 0x04, 0x08};
-    char check_sum_data[2] = {0x00, 0x00};
     uint8_t confirmation_code = 0;
 
-    uint16_t checksum_value = check_sum(tx_cmd_data, buffer_id);
-    check_sum_data[0] = (checksum_value >> 8) & (0xFF);
-    check_sum_data[1] = checksum_value & (0xFF);
-
-    tx_cmd_data[10] = buffer_id[0];
-    for(int i=0; i<4; i++)
-    {
-        tx_cmd_data[i+2] = r307_address[i];
-        if(i<2)
-        {
-            tx_cmd_data[i+11] = check_sum_data[i];
-        }
-    }
-    
-    char instruction_code;
+    confirmation_code = r307_transact_fixed(r307_address, 0x05, 1000);
 
-    instruction_code = tx_cmd_data[9];
+    return confirmation_code;
+}
 
-    const int package_length = sizeof(tx_cmd_data);
-    const int txBytes = uart_write_bytes(UART_NUM_1, tx_cmd_data, package_length);
-    ESP_LOGI(R307_TX, "Wrote %d bytes", txBytes);
-    vTaskDelay(1000 / portTICK_PERIOD_MS);
+uint8_t UpChar(char r307_address[], char buffer_id[])
+{
+    char tx_cmd_data[13];
+    uint8_t confirmation_code = 0;
 
-    confirmation_code = r307_reponse(instruction_code);
+    const int package_length = r307_build_command(tx_cmd_data, r307_address, 0x08, buffer_id, 1);
+    confirmation_code = r307_transact(tx_cmd_data, package_length, 1000);
 
     return confirmation_code;
 }
 
 uint8_t DownChar(char r307_address[], char buffer_id[])
 {
-    char tx_cmd_data[13] = {0xEF, 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 0x00, 0x04, 0x09};
-    char check_sum_data[2] = {0x00, 0x00};
+    char tx_cmd_data[13];
     uint8_t confirmation_code = 0;
 
-    uint16_t checksum_value = check_sum(tx_cmd_data, buffer_id);
-    check_sum_data[0] = (checksum_value >> 8) & (0xFF);
-    check_sum_data[1] = checksum_value & (0xFF);
+    const int package_length = r307_build_command(tx_cmd_data, r307_address, 0x09, buffer_id, 1);
+    confirmation_code = r307_transact(tx_cmd_data, package_length, 1000);
 
-    tx_cmd_data[10] = buffer_id[0];
-    for(int i=0; i<4; i++)
+    return confirmation_code;
+}
+
+uint8_t r307_up_char(char r307_address[], char buffer_id[], r307_data_cb_t callback, void *arg)
+{
+    char tx_cmd_data[13];
+    uint8_t confirmation_code = 0;
+
+    const int package_length = r307_build_command(tx_cmd_data, r307_address, 0x08, buffer_id, 1);
+    r307_link_acquire();                                                                //++ Acknowledge & Data Packages form one exchange
+    confirmation_code = r307_transact(tx_cmd_data, package_length, 0);                  //++ No delay, Data Packages follow the acknowledge immediately
+    if(confirmation_code == 0x00 && r307_last_response.received)
     {
-        tx_cmd_data[i+2] = r307_address[i];
-        if(i<2)
-        {
-            tx_cmd_data[i+11] = check_sum_data[i];
-        }
+        confirmation_code = r307_receive_data(callback, arg);
     }
-    
-    char instruction_code;
+    r307_link_release();
 
-    instruction_code = tx_cmd_data[9];
+    return confirmation_code;
+}
 
-    const int package_length = sizeof(tx_cmd_data);
-    const int txBytes = uart_write_bytes(UART_NUM_1, tx_cmd_data, package_length);
-    ESP_LOGI(R307_TX, "Wrote %d bytes", txBytes);
-    vTaskDelay(1000 / portTICK_PERIOD_MS);
+uint8_t r307_down_char(char r307_address[], char buffer_id[], const uint8_t data[], int length)
+{
+    char tx_cmd_data[13];
+    uint8_t confirmation_code = 0;
 
-    confirmation_code = r307_reponse(instruction_code);
+    const int package_length = r307_build_command(tx_cmd_data, r307_address, 0x09, buffer_id, 1);
+    r307_link_acquire();                                                                //++ Acknowledge & Data Packages form one exchange
+    confirmation_code = r307_transact(tx_cmd_data, package_length, 0);                  //++ Module waits for the Data Packages right after its acknowledge
+    if(confirmation_code == 0x00 && r307_last_response.received)
+    {
+        confirmation_code = r307_send_data(r307_address, data, length);
+    }
+    r307_link_release();
 
     return confirmation_code;
 }
 
-uint8_t Store(char r307_address[], char buffer_id[], char page_id[])
+uint8_t r307_down_char_begin(char r307_address[], char buffer_id[], r307_data_writer_t *writer, int length)
 {
-    char tx_cmd_data[15] = {0xEF, 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 0x00, 0x06, 0x06};
-    char check_sum_data[2] = {0x00, 0x00};
-    char combined_data[3];
+    char tx_cmd_data[13];
     uint8_t confirmation_code = 0;
 
-    memset(combined_data, 0, strlen(combined_data));
-    strcat(combined_data, buffer_id);
-    strcat(combined_data, page_id);
-
-    uint16_t checksum_value = check_sum(tx_cmd_data, combined_data);
-    check_sum_data[0] = (checksum_value >> 8) & (0xFF);
-    check_sum_data[1] = checksum_value & (0xFF);
-
-    tx_cmd_data[10] = buffer_id[0];
-    for(int i=0; i<4; i++)
+    const int package_length = r307_build_command(tx_cmd_data, r307_address, 0x09, buffer_id, 1);
+    confirmation_code = r307_transact(tx_cmd_data, package_length, 0);                  //++ Module waits for the Data Packages right after its acknowledge
+    if(confirmation_code == 0x00 && r307_last_response.received)
     {
-        tx_cmd_data[i+2] = r307_address[i];
-        if(i<2)
-        {
-            tx_cmd_data[i+13] = check_sum_data[i];
-        }
+        r307_data_writer_begin(writer, r307_address, length);
     }
-    
-    char instruction_code;
 
-    instruction_code = tx_cmd_data[9];
+    return confirmation_code;
+}
 
-    const int package_length = sizeof(tx_cmd_data);
-    const int txBytes = uart_write_bytes(UART_NUM_1, tx_cmd_data, package_length);
-    ESP_LOGI(R307_TX, "Wrote %d bytes", txBytes);
-    ESP_LOG_BUFFER_HEXDUMP("R307_TX", tx_cmd_data, package_length, ESP_LOG_INFO);
-    vTaskDelay(1000 / portTICK_PERIOD_MS);
+uint8_t Store(char r307_address[], char buffer_id[], char page_id[])
+{
+    char tx_cmd_data[15];
+    char packet_data[3] = {buffer_id[0], page_id[0], page_id[1]};
+    uint8_t confirmation_code = 0;
 
-    confirmation_code = r307_reponse(instruction_code);
+    const int package_length = r307_build_command(tx_cmd_data, r307_address, 0x06, packet_data, sizeof(packet_data));
+    confirmation_code = r307_transact(tx_cmd_data, package_length, 1000);
 
     return confirmation_code;
 }
 
 uint8_t LoadChar(char r307_address[], char buffer_id[], char page_id[])
 {
-    char tx_cmd_data[15] = {0xEF, 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 0x00, 0x06, 0x07};
-    char check_sum_data[2] = {0x00, 0x00};
-    char combined_data[3];
+    char tx_cmd_data[15];
+    char packet_data[3] = {buffer_id[0], page_id[0], page_id[1]};
     uint8_t confirmation_code = 0;
 
-    memset(combined_data, 0, strlen(combined_data));
-    combined_data[0] = buffer_id[0];
-    combined_data[1] = page_id[0];
-    combined_data[2] = page_id[1];
-
-    uint16_t checksum_value = check_sum(tx_cmd_data, combined_data);
-    check_sum_data[0] = (checksum_value >> 8) & (0xFF);
-    check_sum_data[1] = checksum_value & (0xFF);
-
-    tx_cmd_data[10] = buffer_id[0];
-    for(int i=0; i<4; i++)
-    {
-        tx_cmd_data[i+2] = r307_address[i];
-        if(i<2)
-        {
-            tx_cmd_data[i+13] = check_sum_data[i];
-        }
-    }
-    
-    char instruction_code;
-
-    instruction_code = tx_cmd_data[9];
-
-    const int package_length = sizeof(tx_cmd_data);
-    const int txBytes = uart_write_bytes(UART_NUM_1, tx_cmd_data, package_length);
-    ESP_LOGI(R307_TX, "Wrote %d bytes", txBytes);
-    ESP_LOG_BUFFER_HEXDUMP("R307_TX", tx_cmd_data, package_length, ESP_LOG_INFO);
-    vTaskDelay(1000 / portTICK_PERIOD_MS);
-
-    confirmation_code = r307_reponse(instruction_code);
+    const int package_length = r307_build_command(tx_cmd_data, r307_address, 0x07, packet_data, sizeof(packet_data));
+    confirmation_code = r307_transact(tx_cmd_data, package_length, 1000);
 
     return confirmation_code;
 }
 
 uint8_t DeletChar(char r307_address[], char page_id[], char number_of_templates[])
 {
-    char tx_cmd_data[16] = {0xEF, 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 0x00, 0x07, 0x0C, 0x00, 0x00, 0x00, 0x01, 0x00, 0x15};
-    char check_sum_data[2] = {0x00, 0x00};
-    char combined_data[4];
+    char tx_cmd_data[16];
+    char packet_data[4] = {page_id[0], page_id[1], number_of_templates[0], number_of_templates[1]};
     uint8_t confirmation_code = 0;
 
-    memset(combined_data, 0, strlen(combined_data));
-    for(int i=0; i<2; i++)
-    {
-        combined_data[i] = page_id[i];
-        combined_data[i+2] = number_of_templates[i];
-    }
-
-    uint16_t checksum_value = check_sum(tx_cmd_data, combined_data);
-    check_sum_data[0] = (checksum_value >> 8) & (0xFF);
-    check_sum_data[1] = checksum_value & (0xFF);
-
-    for(int i=0; i<4; i++)
-    {
-        tx_cmd_data[i+2] = r307_address[i];
-        if(i<2)
-        {
-            tx_cmd_data[i+10] = page_id[i];
-            tx_cmd_data[i+12] = number_of_templates[i];
-            tx_cmd_data[i+14] = check_sum_data[i];
-        }
-    }
-    
-    char instruction_code;
+    const int package_length = r307_build_command(tx_cmd_data, r307_address, 0x0C, packet_data, sizeof(packet_data));
+    confirmation_code = r307_transact(tx_cmd_data, package_length, 1000);
 
-    instruction_code = tx_cmd_data[9];
+    return confirmation_code;
+}
 
-    const int package_length = sizeof(tx_cmd_data);
-    const int txBytes = uart_write_bytes(UART_NUM_1, tx_cmd_data, package_length);
-    ESP_LOGI(R307_TX, "Wrote %d bytes", txBytes);
-    ESP_LOG_BUFFER_HEXDUMP("R307_TX", tx_cmd_data, package_length, ESP_LOG_INFO);
-    vTaskDelay(1000 / portTICK_PERIOD_MS);
+uint8_t Empty(char r307_address[])
+{
+    uint8_t confirmation_code = 0;
 
-    confirmation_code = r307_reponse(instruction_code);
+    confirmation_code = r307_transact_fixed(r307_address, 0x0D, 1000);
 
     return confirmation_code;
 }
 
-uint8_t Empty(char r307_address[])
+uint8_t Match(char r307_address[])
 {
-    char tx_cmd_data[12] = {0xEF, 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 0x00, 0x03, 0x0D};
-    char check_sum_data[2] = {0x00, 0x00};
     uint8_t confirmation_code = 0;
 
-    uint16_t checksum_value = check_sum(tx_cmd_data, "#12");
-    check_sum_data[0] = (checksum_value >> 8) & (0xFF);
-    check_sum_data[1] = checksum_value & (0xFF);
-
-    for(int i=0; i<4; i++)
-    {
-        tx_cmd_data[i+2] = r307_address[i];
-        if(i<2)
-        {
-            tx_cmd_data[i+10] = check_sum_data[i];
-        }
-    }
-    
-    char instruction_code;
+    confirmation_code = r307_transact_fixed(r307_address, 0x03, 1000);
 
-    instruction_code = tx_cmd_data[9];
+    return confirmation_code;
+}
 
-    const int package_length = sizeof(tx_cmd_data);
-    const int txBytes = uart_write_bytes(UART_NUM_1, tx_cmd_data, package_length);
-    ESP_LOGI(R307_TX, "Wrote %d bytes", txBytes);
-    vTaskDelay(1000 / portTICK_PERIOD_MS);
+uint8_t Search(char r307_address[], char buffer_id[], char start_page[], char page_number[])
+{
+    char tx_cmd_data[17];
+    char packet_data[5] = {buffer_id[0], start_page[0], start_page[1], page_number[0], page_number[1]};
+    uint8_t confirmation_code = 0;
 
-    confirmation_code = r307_reponse(instruction_code);
+    const int package_length = r307_build_command(tx_cmd_data, r307_address, 0x04, packet_data, sizeof(packet_data));
+    confirmation_code = r307_transact(tx_cmd_data, package_length, 500);
 
     return confirmation_code;
 }
 
-uint8_t Match(char r307_address[])
+uint8_t GetRandomCode(char r307_address[])
 {
-    char tx_cmd_data[12] = {0xEF, 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 0x00, 0x03, 0x03};
-    char check_sum_data[2] = {0x00, 0x00};
     uint8_t confirmation_code = 0;
 
-    uint16_t checksum_value = check_sum(tx_cmd_data, "#12");
-    check_sum_data[0] = (checksum_value >> 8) & (0xFF);
-    check_sum_data[1] = checksum_value & (0xFF);
+    confirmation_code = r307_transact_fixed(r307_address, 0x14, 1000);
 
-    for(int i=0; i<4; i++)
-    {
-        tx_cmd_data[i+2] = r307_address[i];
-        if(i<2)
-        {
-            tx_cmd_data[i+10] = check_sum_data[i];
-        }
-    }
-    
-    char instruction_code;
+    return confirmation_code;
+}
 
-    instruction_code = tx_cmd_data[9];
+uint8_t WriteNotepad(char r307_address[], char page_number[], const char content[])
+{
+    char tx_cmd_data[45];
+    char packet_data[1 + R307_NOTEPAD_PAGE_SIZE];
+    uint8_t confirmation_code = 0;
 
-    const int package_length = sizeof(tx_cmd_data);
-    const int txBytes = uart_write_bytes(UART_NUM_1, tx_cmd_data, package_length);
-    ESP_LOGI(R307_TX, "Wrote %d bytes", txBytes);
-    vTaskDelay(1000 / portTICK_PERIOD_MS);
+    packet_data[0] = page_number[0];
+    memcpy(&packet_data[1], content, R307_NOTEPAD_PAGE_SIZE);
 
-    confirmation_code = r307_reponse(instruction_code);
+    const int package_length = r307_build_command(tx_cmd_data, r307_address, 0x18, packet_data, sizeof(packet_data));
+    confirmation_code = r307_transact(tx_cmd_data, package_length, 500);
 
     return confirmation_code;
 }
 
-uint8_t Search(char r307_address[], char buffer_id[], char start_page[], char page_number[])
+uint8_t ReadNotepad(char r307_address[], char page_number[])
 {
-    char tx_cmd_data[17] = {0xEF, 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 0x00, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0D};
-    char check_sum_data[2] = {0x00, 0x00};
-    char combined_data[5];
+    char tx_cmd_data[13];
     uint8_t confirmation_code = 0;
 
-    memset(combined_data, 0, strlen(combined_data));
-    for(int i=0; i<2; i++)
-    {
-        combined_data[0] = buffer_id[0];
-        combined_data[i+1] = start_page[i];
-        combined_data[i+3] = page_number[i];
-    }
+    const int package_length = r307_build_command(tx_cmd_data, r307_address, 0x19, page_number, 1);
+    confirmation_code = r307_transact(tx_cmd_data, package_length, 500);
 
-    uint16_t checksum_value = check_sum(tx_cmd_data, combined_data);
-    check_sum_data[0] = (checksum_value >> 8) & (0xFF);
-    check_sum_data[1] = checksum_value & (0xFF);
+    return confirmation_code;
+}
 
-    tx_cmd_data[10] = buffer_id[0];
-    for(int i=0; i<4; i++)
-    {
-        tx_cmd_data[i+2] = r307_address[i];
-        if(i<2)
-        {
-            tx_cmd_data[i+11] = start_page[i];
-            tx_cmd_data[i+13] = page_number[i];
-            tx_cmd_data[i+15] = check_sum_data[i];
-        }
-    }
-    
-    char instruction_code;
+uint8_t SetSysPara(char r307_address[], char parameter_number[], char content[])
+{
+    char tx_cmd_data[14];
+    char packet_data[2] = {parameter_number[0], content[0]};
+    uint8_t confirmation_code = 0;
+
+    const int package_length = r307_build_command(tx_cmd_data, r307_address, 0x0E, packet_data, sizeof(packet_data));
+    confirmation_code = r307_transact(tx_cmd_data, package_length, 500);
 
-    instruction_code = tx_cmd_data[9];
+    return confirmation_code;
+}
 
-    const int package_length = sizeof(tx_cmd_data);
-    const int txBytes = uart_write_bytes(UART_NUM_1, tx_cmd_data, package_length);
-    ESP_LOGI(R307_TX, "Wrote %d bytes", txBytes);
-    vTaskDelay(500 / portTICK_PERIOD_MS);
+uint8_t ReadIndexTable(char r307_address[], char index_page[])
+{
+    char tx_cmd_data[13];
+    uint8_t confirmation_code = 0;
 
-    confirmation_code = r307_reponse(instruction_code);
+    const int package_length = r307_build_command(tx_cmd_data, r307_address, 0x1F, index_page, 1);
+    confirmation_code = r307_transact(tx_cmd_data, package_length, 500);
 
     return confirmation_code;
 }
 
-uint8_t GetRandomCode(char r307_address[])
+uint8_t GetImageEx(char r307_address[])
 {
-    char tx_cmd_data[12] = {0xEF, 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 0x00, 0x03, 0x14};
-    char check_sum_data[2] = {0x00, 0x00};
     uint8_t confirmation_code = 0;
 
-    uint16_t checksum_value = check_sum(tx_cmd_data, "#12");
-    check_sum_data[0] = (checksum_value >> 8) & (0xFF);
-    check_sum_data[1] = checksum_value & (0xFF);
-
-    for(int i=0; i<4; i++)
-    {
-        tx_cmd_data[i+2] = r307_address[i];
-        if(i<2)
-        {
-            tx_cmd_data[i+10] = check_sum_data[i];
-        }
-    }
-    
-    char instruction_code;
+    confirmation_code = r307_transact_fixed(r307_address, 0x28, 1000);
 
-    instruction_code = tx_cmd_data[9];
+    return confirmation_code;
+}
 
-    const int package_length = sizeof(tx_cmd_data);
-    const int txBytes = uart_write_bytes(UART_NUM_1, tx_cmd_data, package_length);
-    ESP_LOGI(R307_TX, "Wrote %d bytes", txBytes);
-    vTaskDelay(1000 / portTICK_PERIOD_MS);
+uint8_t HighSpeedSearch(char r307_address[], char buffer_id[], char start_page[], char page_number[])
+{
+    char tx_cmd_data[17];
+    char packet_data[5] = {buffer_id[0], start_page[0], start_page[1], page_number[0], page_number[1]};
+    uint8_t confirmation_code = 0;
 
-    confirmation_code = r307_reponse(instruction_code);
+    const int package_length = r307_build_command(tx_cmd_data, r307_address, 0x1B, packet_data, sizeof(packet_data));
+    confirmation_code = r307_transact(tx_cmd_data, package_length, 500);
 
     return confirmation_code;
 }
 
-void r307_response_parser(char instruction_code[], uint8_t received_package[])
+void r307_response_parser(char instruction_code, uint8_t received_package[])
 {
     uint8_t confirmation_code = received_package[9];                                    //++ Get Confirmation Code from received response packet 
 
@@ -924,6 +1533,13 @@ void r307_response_parser(char instruction_code[], uint8_t received_package[])
         {
             ESP_LOGI("ReadSysPara", "(0x00H) SYSTEM READ COMPLETE");
 
+            r307_last_response.status_register = (received_package[10] << 8) | received_package[11];
+            r307_last_response.library_size = (received_package[14] << 8) | received_package[15];
+            r307_last_response.security_level = (received_package[16] << 8) | received_package[17];
+            memcpy(r307_last_response.device_address, &received_package[18], 4);
+            r307_last_response.size_code = (received_package[22] << 8) | received_package[23];
+            r307_last_response.baud_n = (received_package[24] << 8) | received_package[25];
+
             ESP_LOGW("SYSTEM PARAMETER", "Library Size - %x:%x", received_package[14],received_package[15]);
             ESP_LOGW("SYSTEM PARAMETER", "Security Level - %x", received_package[17]);
             ESP_LOGW("SYSTEM PARAMETER", "32bit Address - %x:%x:%x:%x", received_package[18], received_package[19], received_package[20], received_package[21]);
@@ -943,7 +1559,8 @@ void r307_response_parser(char instruction_code[], uint8_t received_package[])
             uint16_t template_number = 0;
             ESP_LOGI("TempleteNum", "(0x00H) READ COMPLETE");
 
-            template_number = received_package[10] + received_package[11];
+            template_number = (received_package[10] << 8) | received_package[11];
+            r307_last_response.template_number = template_number;
             ESP_LOGW("SYSTEM PARAMETER", "Template Number - %d\n", template_number);
         }
         else if(confirmation_code == 0x01)
@@ -960,8 +1577,10 @@ void r307_response_parser(char instruction_code[], uint8_t received_package[])
             uint16_t match_score = 0;
             ESP_LOGI("GR_Auto", "(0x00H) READ COMPLETE");
 
-            page_id = received_package[10] + received_package[11];
-            match_score = received_package[12] + received_package[13];
+            page_id = (received_package[10] << 8) | received_package[11];
+            match_score = (received_package[12] << 8) | received_package[13];
+            r307_last_response.page_id = page_id;
+            r307_last_response.match_score = match_score;
             ESP_LOGW("SYSTEM PARAMETER", "Page ID - %d", page_id);
             ESP_LOGW("SYSTEM PARAMETER", "Match Score - %d\n", match_score);
         }
@@ -1181,6 +1800,11 @@ void r307_response_parser(char instruction_code[], uint8_t received_package[])
 
     if(instruction_code == 0x03)
     {
+        if(((received_package[7] << 8) | received_package[8]) == 0x05)                 //++ Score is returned whether the buffers match or not
+        {
+            r307_last_response.match_score = (received_package[10] << 8) | received_package[11];
+        }
+
         if(confirmation_code == 0x00)
         {
             ESP_LOGI("Match", "(0x00H) TWO TEMPLATE BUFFERS MATCH\n");
@@ -1195,7 +1819,7 @@ void r307_response_parser(char instruction_code[], uint8_t received_package[])
         }
     }
 
-    if(instruction_code == 0x04)
+    if(instruction_code == 0x04 || instruction_code == 0x1B)
     {
         if(confirmation_code == 0x00)
         {
@@ -1203,18 +1827,20 @@ void r307_response_parser(char instruction_code[], uint8_t received_package[])
             uint16_t match_score = 0;
             ESP_LOGI("Search", "(0x00H) FOUND MATCHING FINGER");
 
-            page_id = received_package[10] + received_package[11];
-            match_score = received_package[12] + received_package[13];
+            page_id = (received_package[10] << 8) | received_package[11];
+            match_score = (received_package[12] << 8) | received_package[13];
+            r307_last_response.page_id = page_id;
+            r307_last_response.match_score = match_score;
             ESP_LOGW("SYSTEM PARAMETER", "Page ID - %d", page_id);
             ESP_LOGW("SYSTEM PARAMETER", "Match Score - %d\n", match_score);
         }
         else if(confirmation_code == 0x01)
         {
-            ESP_LOGE("Search", "(0x01H) ERROR RECEIVING PACKAGE\n");
+            ESP_LOGE("Search/HighSpeedSearch", "(0x01H) ERROR RECEIVING PACKAGE\n");
         }
         else if(confirmation_code == 0x09)
         {
-            ESP_LOGE("Search", "(0x09H) NO MATCHING FINGER IN LIBRARY\n");
+            ESP_LOGE("Search/HighSpeedSearch", "(0x09H) NO MATCHING FINGER IN LIBRARY\n");
         }
     }
 
@@ -1232,5 +1858,87 @@ void r307_response_parser(char instruction_code[], uint8_t received_package[])
         }
     }
 
+    if(instruction_code == 0x18)
+    {
+        if(confirmation_code == 0x00)
+        {
+            ESP_LOGI("WriteNotepad", "(0x00H) WRITE COMPLETE\n");
+        }
+        else if(confirmation_code == 0x01)
+        {
+            ESP_LOGE("WriteNotepad", "(0x01H) ERROR RECEIVING PACKAGE\n");
+        }
+        else if(confirmation_code == 0x18)
+        {
+            ESP_LOGE("WriteNotepad", "(0x18H) ERROR WRITING FLASH\n");
+        }
+    }
+
+    if(instruction_code == 0x19)
+    {
+        if(confirmation_code == 0x00)
+        {
+            ESP_LOGI("ReadNotepad", "(0x00H) READ COMPLETE\n");
+            memcpy(r307_last_response.notepad, &received_package[10], R307_NOTEPAD_PAGE_SIZE);
+        }
+        else if(confirmation_code == 0x01)
+        {
+            ESP_LOGE("ReadNotepad", "(0x01H) ERROR RECEIVING PACKAGE\n");
+        }
+    }
+
+    if(instruction_code == 0x0E)
+    {
+        if(confirmation_code == 0x00)
+        {
+            ESP_LOGI("SetSysPara", "(0x00H) PARAMETER SETTING COMPLETE\n");
+        }
+        else if(confirmation_code == 0x01)
+        {
+            ESP_LOGE("SetSysPara", "(0x01H) ERROR RECEIVING PACKAGE\n");
+        }
+        else if(confirmation_code == 0x1A)
+        {
+            ESP_LOGE("SetSysPara", "(0x1AH) WRONG REGISTER NUMBER\n");
+        }
+    }
+
+    if(instruction_code == 0x1F)
+    {
+        if(confirmation_code == 0x00)
+        {
+            ESP_LOGI("ReadIndexTable", "(0x00H) READ COMPLETE\n");
+            memcpy(r307_last_response.index_table, &received_package[10], R307_INDEX_TABLE_SIZE);
+        }
+        else if(confirmation_code == 0x01)
+        {
+            ESP_LOGE("ReadIndexTable", "(0x01H) ERROR RECEIVING PACKAGE\n");
+        }
+    }
+
+    if(instruction_code == 0x28)
+    {
+        if(confirmation_code == 0x00)
+        {
+            ESP_LOGI("GetImageEx", "(0x00H) FINGER COLLECTION SUCCESS\n");
+        }
+        else if(confirmation_code == 0x01)
+        {
+            ESP_LOGE("GetImageEx", "(0x01H) ERROR RECEIVING PACKAGE\n");
+        }
+        else if(confirmation_code == 0x02)
+        {
+            ESP_LOGE("GetImageEx", "(0x02H) NO FINGER DETECED\n");
+        }
+        else if(confirmation_code == 0x03)
+        {
+            ESP_LOGE("GetImageEx", "(0x03H) FAIL TO COLLECT FINGER\n");
+        }
+        else if(confirmation_code == 0x07)
+        {
+            ESP_LOGE("GetImageEx", "(0x07H) POOR IMAGE QUALITY\n");
+        }
+    }
+
 }
 
@@ -1,4 +1,5 @@
 #include <stdint.h>
+#include "driver/uart.h"
 
 #ifndef r307_H
 #define r307_H
@@ -7,6 +8,151 @@
 extern "C" {
 #endif
 
+#define R307_MAX_PACKAGE_SIZE (9 + 256 + 2)      //++ Header, Address, PID & Length + largest Data Packet + Checksum
+#define R307_IMAGE_SIZE (256 * 288 / 2)         //++ Bytes of an image in IMG_BUFFER ( 4-bit pixels )
+#define R307_TEMPLATE_SIZE (512)                //++ Bytes of a template in CHARBUFFER1/CHARBUFFER2
+#define R307_NOTEPAD_PAGES (16)                 //++ Pages of the user notepad in the module's flash
+#define R307_NOTEPAD_PAGE_SIZE (32)             //++ Bytes of one notepad page
+#define R307_INDEX_TABLE_SIZE (32)              //++ Bytes of one ReadIndexTable page ( 256 library pages )
+#define R307_FIXED_FRAME_SIZE (12)              //++ Bytes of a command package without Packet Data
+#define R307_TIMING_OPCODES (0x40)              //++ Instruction Codes whose acknowledge latency is learned
+#define R307_TIMEOUT (0xFF)                     //++ Confirmation Code returned when the module did not answer ( never sent by the module )
+
+/**
+ * @brief COMMAND PACKAGE OF AN INSTRUCTION WITHOUT PACKET DATA FOR THE DEFAULT ADDRESS 0xFFFFFFFF, BUILT BY THE COMPILER
+ *
+ * @param instruction_code INSTRUCTION CODE ( CHECKSUM = PACKAGE IDENTIFIER 0x01 + PACKAGE LENGTH 0x0003 + INSTRUCTION CODE )
+ */
+#define R307_DEFAULT_FRAME(instruction_code) {0xEF, 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 0x00, 0x03, (instruction_code), ((0x04 + (instruction_code)) >> 8) & 0xFF, (0x04 + (instruction_code)) & 0xFF}
+#define R307_SYS_PARA_BAUD (4)                  //++ SetSysPara Parameter Number : Baud Multiplier N ( Baud = N x 9600 )
+#define R307_SYS_PARA_SECURITY (5)              //++ SetSysPara Parameter Number : Security Level 1 .. 5
+#define R307_SYS_PARA_PACKET_SIZE (6)           //++ SetSysPara Parameter Number : Data Packet Size Code 0:32 1:64 2:128 3:256 Bytes
+
+/**
+ * @brief RESULT OF READING ONE PACKAGE FROM THE MODULE
+ */
+typedef enum
+{
+    R307_RX_OK = 0,                         //++ Complete package with valid checksum
+    R307_RX_TIMEOUT,                        //++ Nothing received
+    R307_RX_BAD_HEADER,                     //++ Bytes received but no 0xEF01 header
+    R307_RX_BAD_CHECKSUM,                   //++ Checksum of the package does not match
+    R307_RX_BAD_PID,                        //++ Unexpected Package Identifier
+    R307_RX_BAD_LENGTH,                     //++ Package truncated or length does not match the command
+} r307_rx_status_t;
+
+/**
+ * @brief CALLBACK RECEIVING THE CONTENTS OF EACH DATA PACKAGE OF A TRANSFER
+ *
+ * @param data CONTENTS OF THE DATA PACKAGE ( WITHOUT HEADER & CHECKSUM )
+ * @param length NUMBER OF BYTES IN data
+ * @param arg USER ARGUMENT
+ * @return RETURN 0 TO CONTINUE, ANY OTHER VALUE ABORTS THE TRANSFER
+ */
+typedef int (*r307_data_cb_t)(const uint8_t data[], int length, void *arg);
+
+/**
+ * @brief STATE OF AN OUTGOING TRANSFER, SPLITS BYTES INTO DATA PACKAGES OF THE CONFIGURED PACKET SIZE
+ */
+typedef struct
+{
+    uint8_t package[R307_MAX_PACKAGE_SIZE]; //++ Data Package being filled
+    int fill;                               //++ Bytes of contents in package
+    int remaining;                          //++ Bytes of the transfer not written yet
+    int packet_size;                        //++ Contents per Data Package
+} r307_data_writer_t;
+
+/**
+ * @brief LINK DESYNC & RECOVERY COUNTERS
+ */
+typedef struct
+{
+    uint32_t commands;                      //++ Commands sent ( retries not counted )
+    uint32_t timeouts;                      //++ Commands left unanswered
+    uint32_t desyncs;                       //++ Broken acknowledges received
+    uint32_t bad_header;                    //++ Desyncs caused by a missing header
+    uint32_t bad_checksum;                  //++ Desyncs caused by a bad checksum
+    uint32_t bad_pid;                       //++ Desyncs caused by an unexpected Package Identifier
+    uint32_t bad_length;                    //++ Desyncs caused by a truncated package or opcode mismatch
+    uint32_t resync_bytes;                  //++ Bytes skipped while hunting for a header
+    uint32_t retries;                       //++ Commands sent again after a desync
+    uint32_t probes;                        //++ Probe commands sent before a retry
+    uint32_t recoveries;                    //++ Commands that succeeded after at least one retry
+    uint32_t failures;                      //++ Commands that ran out of retry budget
+    uint32_t saved_round_trips;             //++ LoadChar / Img2Tz skipped because the char buffer already held the result
+    uint32_t rx_wakeups;                    //++ Times a read woke up on a UART event ( one per received burst )
+    uint32_t rx_overflows;                  //++ UART FIFO or ring buffer overflows, bytes were lost
+    uint32_t frame_rebuilds;                //++ Times the precomputed command packages were patched for a new module address
+} r307_link_stats_t;
+
+/**
+ * @brief EFFECTIVE THROUGHPUT OF THE DATA PACKAGES RECEIVED AT ONE PACKET SIZE ( UpChar / UpImage )
+ */
+typedef struct
+{
+    uint32_t transfers;                     //++ Transfers completed up to the End of Data package
+    uint32_t bytes;                         //++ Contents received, without header & checksum
+    int64_t time_us;                        //++ Time from the acknowledge to the End of Data package
+} r307_transfer_stats_t;
+
+/**
+ * @brief LEARNED ACKNOWLEDGE LATENCY OF ONE INSTRUCTION & THE DEADLINE DERIVED FROM IT
+ */
+typedef struct
+{
+    uint32_t samples;                       //++ Acknowledges measured
+    int32_t average_us;                     //++ Moving average of the latency ( weight 1/8 per sample )
+    int32_t deviation_us;                   //++ Moving mean deviation of the latency ( weight 1/4 per sample )
+    uint32_t timeouts;                      //++ Acknowledges missed while the learned deadline was used
+    uint16_t override_ms;                   //++ Deadline set with r307_set_command_timeout ( 0 : Learned )
+    uint16_t deadline_ms;                   //++ Deadline the next command will wait for its acknowledge ( 0 : Default of the command or, for a Search, page_cost_us based )
+    uint16_t page_cost_us;                  //++ Search & HighSpeedSearch : slowest latency per compared page ( 0 : Not learned, default deadline )
+} r307_command_timing_t;
+
+/**
+ * @brief WHERE THE CONTENTS OF A CHARBUFFER CAME FROM
+ */
+typedef enum
+{
+    R307_CHAR_UNKNOWN = 0,                  //++ Not known ( power up, failed or unanswered command, page changed )
+    R307_CHAR_PAGE,                         //++ Same as a library page ( LoadChar, or Store of this buffer )
+    R307_CHAR_IMAGE,                        //++ Generated by Img2Tz from the image now in ImageBuffer
+    R307_CHAR_DOWNLOADED,                   //++ Written by DownChar
+    R307_CHAR_MODEL,                        //++ Template merged by RegModel
+} r307_char_source_t;
+
+/**
+ * @brief PROVENANCE OF ONE CHARBUFFER, TRACKED BY THE DRIVER FROM THE COMMANDS IT SENDS
+ */
+typedef struct
+{
+    r307_char_source_t source;              //++ Where the contents came from
+    uint16_t page_id;                       //++ Library page ( R307_CHAR_PAGE )
+    uint32_t image_generation;              //++ Image the contents were generated from ( R307_CHAR_IMAGE )
+} r307_char_buffer_t;
+
+/**
+ * @brief TYPED FIELDS OF THE LAST RESPONSE RECEIVED FROM R307 FINGERPRINT MODULE
+ */
+typedef struct
+{
+    uint8_t received;                       //++ 1 : A Response Package was Received | 0 : No Response
+    r307_rx_status_t rx_status;             //++ Result of reading the acknowledge package
+    uint8_t instruction_code;               //++ Instruction Code of the Command that produced this Response
+    uint8_t confirmation_code;              //++ Confirmation Code of the Response
+    uint16_t page_id;                       //++ Page ID returned by Search / HighSpeedSearch / GR_Auto / GR_Identify
+    uint16_t match_score;                   //++ Match Score returned by Search / HighSpeedSearch / Match / GR_Auto / GR_Identify
+    uint16_t template_number;               //++ Valid Template Number returned by TempleteNum
+    uint16_t status_register;               //++ Status Register returned by ReadSysPara
+    uint16_t library_size;                  //++ Finger Library Size returned by ReadSysPara
+    uint16_t security_level;                //++ Security Level returned by ReadSysPara
+    uint8_t device_address[4];              //++ 32-bit Module Address returned by ReadSysPara
+    uint16_t size_code;                     //++ Data Packet Size Code returned by ReadSysPara ( 0:32 1:64 2:128 3:256 Bytes )
+    uint16_t baud_n;                        //++ Baud Multiplier returned by ReadSysPara ( Baud = N x 9600 )
+    uint8_t notepad[R307_NOTEPAD_PAGE_SIZE]; //++ Page contents returned by ReadNotepad
+    uint8_t index_table[R307_INDEX_TABLE_SIZE]; //++ Occupancy bits returned by ReadIndexTable ( bit n : page n of the index page )
+} r307_response_t;
+
 /**
  * @brief INITIALIZE UART FOR R307 FINGERPRINT MODULE
  *
@@ -14,13 +160,257 @@ extern "C" {
  */
 void r307_init(void);
 
+/**
+ * @brief INITIALIZE A UART FOR AN R307 MODULE ON ANY PORT & SELECT IT ( ONE PORT PER MODULE )
+ *
+ * @param uart_port UART PORT THE MODULE IS WIRED TO
+ * @param tx_pin ESP32 TX PIN ( TO MODULE RXD )
+ * @param rx_pin ESP32 RX PIN ( FROM MODULE TXD )
+ * @return
+ */
+void r307_init_port(uart_port_t uart_port, int tx_pin, int rx_pin);
+
+/**
+ * @brief FUNCTION TO SELECT THE PORT ALL FOLLOWING COMMANDS ARE SENT TO, WHEN TASKS SHARE THE LINK SELECT IT AFTER r307_link_acquire
+ *        AND RESTORE THE PREVIOUS PORT BEFORE r307_link_release
+ *
+ * @param uart_port UART PORT INSTALLED WITH r307_init_port ( UART_NUM_1 FOR r307_init )
+ * @return RETURNS PREVIOUSLY SELECTED PORT
+ */
+uart_port_t r307_select_port(uart_port_t uart_port);
+
+/**
+ * @brief RELEASE UART & FLOAT ITS PINS ( USED BEFORE CUTTING SENSOR POWER )
+ *
+ * @return
+ */
+void r307_deinit(void);
+
+/**
+ * @brief FUNCTION TO SET THE UART BAUD USED FOR THE MODULE
+ *
+ * @param baud_rate NEW BAUD ( MUST MATCH THE BAUD CONFIGURED IN THE MODULE )
+ * @return
+ */
+void r307_set_baud_rate(uint32_t baud_rate);
+
+/**
+ * @brief FUNCTION TO GET THE UART BAUD USED FOR THE MODULE
+ *
+ * @return RETURNS CURRENT UART BAUD
+ */
+uint32_t r307_get_baud_rate(void);
+
+/**
+ * @brief FUNCTION TO GET THE LINK GENERATION, INCREMENTED EVERY TIME r307_init INSTALLS THE UART
+ *
+ * @return RETURNS CURRENT LINK GENERATION ( STATE CACHED UNDER AN OLDER GENERATION IS STALE )
+ */
+uint32_t r307_get_link_generation(void);
+
+/**
+ * @brief FUNCTION TO SET THE DATA PACKAGE SIZE USED FOR TRANSFERS ( MUST MATCH THE MODULE )
+ *
+ * @param packet_size 32, 64, 128 OR 256 BYTES
+ * @return
+ */
+void r307_set_packet_size(uint16_t packet_size);
+
+/**
+ * @brief FUNCTION TO GET THE DATA PACKAGE SIZE USED FOR TRANSFERS
+ *
+ * @return RETURNS DATA PACKAGE SIZE IN BYTES
+ */
+uint16_t r307_get_packet_size(void);
+
 /**
  * @brief FUNCITON TO GET RESPONSES FROM R307 FINGERPRINT MODULE
  *
  * @param instruction_code INSTRUCTION CODE FOR EACH COMMAND
- * @return RETURNS CONFIRMATION CODE RECEIVED FROM THE RESPONSE
+ * @return RETURNS CONFIRMATION CODE RECEIVED FROM THE RESPONSE, 0x01 IF THE PACKAGE WAS BROKEN, R307_TIMEOUT IF NOTHING WAS RECEIVED
+ */
+uint8_t r307_reponse(char instruction_code);
+
+/**
+ * @brief FUNCTION TO DROP EVERYTHING RECEIVED BUT NOT READ YET ( UART RING BUFFER, PENDING EVENTS & PARSER CHUNK )
+ *
+ * @return
+ */
+void r307_flush_input(void);
+
+/**
+ * @brief FUNCTION TO WAIT FOR ONE EXPECTED BYTE ON THE SELECTED PORT ( E.G. THE 0x55 SENT BY THE MODULE AFTER POWER-ON ), OTHER BYTES ARE DROPPED
+ *
+ * @param expected_byte BYTE TO WAIT FOR
+ * @param timeout_ms MAXIMUM TIME TO WAIT
+ * @return RETURNS 1 IF THE BYTE WAS RECEIVED, 0 ON TIMEOUT
+ */
+uint8_t r307_wait_for_byte(uint8_t expected_byte, int timeout_ms);
+
+/**
+ * @brief FUNCTION TO READ ONE COMPLETE PACKAGE, RESYNCHRONIZING ON THE 0xEF01 HEADER
+ *
+ * @param received_package BUFFER FOR THE PACKAGE
+ * @param package_size SIZE OF THE BUFFER
+ * @param timeout_ms MAXIMUM TIME TO WAIT FOR THE WHOLE PACKAGE
+ * @param package_length FILLED WITH THE LENGTH OF THE PACKAGE ( 0 ON ERROR )
+ * @return RETURNS R307_RX_OK OR THE REASON THE PACKAGE WAS REJECTED
+ */
+r307_rx_status_t r307_read_package(uint8_t received_package[], int package_size, int timeout_ms, int *package_length);
+
+/**
+ * @brief FUNCTION TO SEND A COMMAND & RECEIVE ITS ACKNOWLEDGE, RETRYING AFTER A LINK DESYNC
+ *
+ * @param tx_cmd_data ENTIRE COMMAND PACKAGE
+ * @param package_length LENGTH OF THE COMMAND PACKAGE
+ * @param delay_ms TIME THE MODULE MAY NEED BEFORE IT ACKNOWLEDGES, ADDED TO THE READ DEADLINE UNTIL A LATENCY HAS BEEN LEARNED FOR THE INSTRUCTION
+ * @return RETURNS CONFIRMATION CODE RECEIVED FROM THE RESPONSE ( 0x01 IF RETRY BUDGET RAN OUT, R307_TIMEOUT IF THE MODULE DID NOT ANSWER )
+ */
+uint8_t r307_transact(char tx_cmd_data[], int package_length, int delay_ms);
+
+/**
+ * @brief FUNCTION TO REGISTER HOOKS THAT GRANT EXCLUSIVE USE OF THE LINK ( E.G. r307_sched ), CALLED AROUND EVERY COMMAND
+ *
+ * @param acquire BLOCKS UNTIL THE CALLING TASK OWNS THE LINK, MUST BE RECURSIVE ( NULL : NO LOCKING )
+ * @param release GIVES UP ONE LEVEL OF OWNERSHIP
+ * @return
+ */
+void r307_set_link_hooks(void (*acquire)(void), void (*release)(void));
+
+/**
+ * @brief FUNCTION TO OWN THE LINK ACROSS SEVERAL COMMANDS ( E.G. LoadChar + UpChar ), NO-OP WITHOUT HOOKS
+ *
+ * @return
+ */
+void r307_link_acquire(void);
+
+/**
+ * @brief FUNCTION TO GIVE UP THE LINK TAKEN WITH r307_link_acquire
+ *
+ * @return
+ */
+void r307_link_release(void);
+
+/**
+ * @brief FUNCTION TO RECEIVE THE DATA PACKAGES FOLLOWING AN UPLOAD ACKNOWLEDGE
+ *
+ * @param callback CALLED WITH THE CONTENTS OF EVERY DATA PACKAGE AS IT ARRIVES
+ * @param arg USER ARGUMENT PASSED TO THE CALLBACK
+ * @return RETURNS 0x00 AFTER THE END OF DATA PACKAGE, 0x01 IF THE TRANSFER BROKE OR WAS ABORTED, R307_TIMEOUT IF THE MODULE WENT SILENT
+ */
+uint8_t r307_receive_data(r307_data_cb_t callback, void *arg);
+
+/**
+ * @brief FUNCTION TO START AN OUTGOING TRANSFER OF A KNOWN NUMBER OF BYTES
+ *
+ * @param writer WRITER TO INITIALIZE
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @param total_length BYTES OF THE WHOLE TRANSFER, THE LAST ONE CLOSES THE END OF DATA PACKAGE
+ * @return
+ */
+void r307_data_writer_begin(r307_data_writer_t *writer, char r307_address[], int total_length);
+
+/**
+ * @brief FUNCTION TO WRITE BYTES OF AN OUTGOING TRANSFER, FULL DATA PACKAGES ARE SENT AS SOON AS THEY FILL
+ *
+ * @param data BYTES TO SEND
+ * @param length NUMBER OF BYTES IN data
+ * @param arg WRITER ( r307_data_writer_t * ), SO IT CAN BE PASSED AS r307_data_cb_t
+ * @return RETURNS 0 ON SUCCESS, 1 IF MORE BYTES THAN ANNOUNCED WERE WRITTEN
+ */
+int r307_data_writer_write(const uint8_t data[], int length, void *arg);
+
+/**
+ * @brief FUNCTION TO FINISH A TRANSFER WHOSE SOURCE FAILED WITH ZEROS, SO THE MODULE STILL GETS ITS END OF DATA PACKAGE & THE LINK STAYS IN SYNC
+ *
+ * @param writer WRITER OF THE BROKEN TRANSFER
+ * @return
+ */
+void r307_data_writer_pad(r307_data_writer_t *writer);
+
+/**
+ * @brief FUNCTION TO SEND A WHOLE BUFFER AS DATA PACKAGES
+ *
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @param data BYTES TO SEND
+ * @param length NUMBER OF BYTES IN data
+ * @return RETURNS 0x00 ON SUCCESS
+ */
+uint8_t r307_send_data(char r307_address[], const uint8_t data[], int length);
+
+/**
+ * @brief FUNCTION TO SET HOW A COMMAND RECOVERS FROM A LINK DESYNC
+ *
+ * @param retry_budget NUMBER OF RETRIES AFTER A DESYNC ( 0 : NO RETRY )
+ * @param probe_enabled 1 : SEND A CHEAP PROBE COMMAND BEFORE EVERY RETRY
+ * @return
+ */
+void r307_set_retry_budget(uint8_t retry_budget, uint8_t probe_enabled);
+
+/**
+ * @brief FUNCTION TO READ THE LINK DESYNC & RECOVERY COUNTERS
+ *
+ * @param stats FILLED WITH THE CURRENT COUNTERS
+ * @return
  */
-uint8_t r307_reponse(char instruction_code[]);
+void r307_get_link_stats(r307_link_stats_t *stats);
+
+/**
+ * @brief FUNCTION TO RESET THE LINK DESYNC & RECOVERY COUNTERS ( & THE TRANSFER COUNTERS )
+ *
+ * @return
+ */
+void r307_reset_link_stats(void);
+
+/**
+ * @brief FUNCTION TO FIX THE ACKNOWLEDGE DEADLINE OF AN INSTRUCTION INSTEAD OF LEARNING IT
+ *
+ * @param instruction_code INSTRUCTION CODE ( BELOW R307_TIMING_OPCODES )
+ * @param timeout_ms DEADLINE IN MILLISECONDS ( 0 : BACK TO THE LEARNED DEADLINE )
+ * @return
+ */
+void r307_set_command_timeout(uint8_t instruction_code, uint16_t timeout_ms);
+
+/**
+ * @brief FUNCTION TO READ THE LEARNED LATENCY & CURRENT DEADLINE OF AN INSTRUCTION
+ *
+ * @param instruction_code INSTRUCTION CODE ( BELOW R307_TIMING_OPCODES )
+ * @param timing FILLED WITH THE LEARNED VALUES
+ * @return
+ */
+void r307_get_command_timing(uint8_t instruction_code, r307_command_timing_t *timing);
+
+/**
+ * @brief FUNCTION TO RESTORE LEARNED LATENCY OF AN INSTRUCTION ( E.G. SAVED BEFORE A REBOOT ), OVERRIDES ARE KEPT
+ *
+ * @param instruction_code INSTRUCTION CODE ( BELOW R307_TIMING_OPCODES )
+ * @param timing samples, average_us, deviation_us & page_cost_us TO RESTORE
+ * @return
+ */
+void r307_set_command_timing(uint8_t instruction_code, const r307_command_timing_t *timing);
+
+/**
+ * @brief FUNCTION TO FORGET ALL LEARNED LATENCIES ( E.G. AFTER CHANGING BAUD OR LIBRARY SIZE ), OVERRIDES ARE KEPT
+ *
+ * @return
+ */
+void r307_reset_command_timing(void);
+
+/**
+ * @brief FUNCTION TO READ THE THROUGHPUT OF RECEIVED DATA TRANSFERS AT ONE PACKET SIZE
+ *
+ * @param packet_size 32, 64, 128 OR 256 BYTES
+ * @param stats FILLED WITH THE COUNTERS ( BYTES x 1000000 / time_us = BYTES PER SECOND )
+ * @return
+ */
+void r307_get_transfer_stats(uint16_t packet_size, r307_transfer_stats_t *stats);
+
+/**
+ * @brief FUNCTION TO GET THE TYPED FIELDS OF THE LAST RESPONSE RECEIVED FROM THE MODULE
+ *
+ * @return RETURNS POINTER TO THE LAST PARSED RESPONSE ( VALID UNTIL THE NEXT COMMAND )
+ */
+const r307_response_t *r307_get_response(void);
 
 /**
  * @brief FUNCTION TO PERFORM CHECKSUM MODULE 256
@@ -31,6 +421,60 @@ uint8_t r307_reponse(char instruction_code[]);
  */
 uint16_t check_sum(char tx_cmd_data[], char r307_data[]);
 
+/**
+ * @brief FUNCTION TO GET THE TRACKED PROVENANCE OF A CHARBUFFER OF THE MODULE ON THE SELECTED PORT ( TRACKED PER PORT )
+ *
+ * @param buffer_id 0x01 : CHARBUFFER1 | 0x02 : CHARBUFFER2
+ * @param state FILLED WITH THE PROVENANCE ( R307_CHAR_UNKNOWN AFTER r307_init )
+ * @return
+ */
+void r307_get_char_buffer(char buffer_id, r307_char_buffer_t *state);
+
+/**
+ * @brief FUNCTION TO FORGET WHAT THE CHARBUFFERS OF THE MODULE ON THE SELECTED PORT HOLD ( E.G. AFTER COMMANDS SENT AROUND THE DRIVER )
+ *
+ * @return
+ */
+void r307_invalidate_char_buffers(void);
+
+/**
+ * @brief FUNCTION TO GET A COUNTER INCREMENTED WHENEVER A LIBRARY PAGE MAY HAVE CHANGED ( Store, DeletChar, Empty, GR_Auto )
+ *
+ * @return RETURNS THE LIBRARY GENERATION, COMPARE TWO VALUES TO DETECT A CHANGE
+ */
+uint32_t r307_get_library_generation(void);
+
+/**
+ * @brief FUNCTION TO LOAD A PAGE WITH LoadChar, SKIPPED IF THE CHARBUFFER ALREADY HOLDS THAT PAGE
+ *
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @param buffer_id BUFFER ID ( CHARACTER FILE BUFFER NUMBER )
+ * @param page_id PAGE ID ( FLASH LOCATION OF THE TEMPLATE )
+ * @return RETURNS RECEIVED CONFIRMATION CODE FROM MODULE, 0x00 WHEN SKIPPED ( r307_get_response IS THEN MARKED RECEIVED )
+ */
+uint8_t r307_load_char_cached(char r307_address[], char buffer_id[], char page_id[]);
+
+/**
+ * @brief FUNCTION TO GENERATE A CHARACTER FILE WITH Img2Tz, SKIPPED IF THE CHARBUFFER WAS ALREADY GENERATED FROM THE CURRENT IMAGE
+ *
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @param buffer_id BUFFER ID ( CHARACTER FILE BUFFER NUMBER )
+ * @return RETURNS RECEIVED CONFIRMATION CODE FROM MODULE, 0x00 WHEN SKIPPED ( r307_get_response IS THEN MARKED RECEIVED )
+ */
+uint8_t r307_img2tz_cached(char r307_address[], char buffer_id[]);
+
+/**
+ * @brief FUNCTION TO BUILD A COMMAND PACKAGE WITH ITS CHECKSUM
+ *
+ * @param tx_cmd_data BUFFER FOR THE PACKAGE ( AT LEAST data_length + 12 BYTES )
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @param instruction_code INSTRUCTION CODE OF THE COMMAND
+ * @param packet_data DATA OF THE COMMAND ( BUFFER ID, PAGE ID, ETC. )
+ * @param data_length NUMBER OF BYTES IN packet_data
+ * @return RETURNS LENGTH OF THE PACKAGE
+ */
+int r307_build_command(char tx_cmd_data[], char r307_address[], char instruction_code, const char packet_data[], int data_length);
+
 /**
  * @brief FUNCTION TO VERIFY PASSWORD BY HANDSHAKING
  *
@@ -115,6 +559,16 @@ uint8_t GenImg(char r307_address[]);
  */
 uint8_t UpImage(char r307_address[]);
 
+/**
+ * @brief FUNCTION TO UPLOAD THE IMAGE IN IMG_BUFFER & STREAM ITS DATA PACKAGES TO A CALLBACK
+ *
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @param callback CALLED WITH THE CONTENTS OF EVERY DATA PACKAGE ( 2 PIXELS PER BYTE, HIGH NIBBLE FIRST )
+ * @param arg USER ARGUMENT PASSED TO THE CALLBACK
+ * @return RETURNS RECEIVED CONFIRMATION CODE FROM MODULE, OR 0x01 IF THE TRANSFER BROKE
+ */
+uint8_t r307_up_image(char r307_address[], r307_data_cb_t callback, void *arg);
+
 /**
  * @brief FUNCTION TO DOWNLOAD IMAGE FROM UPPER COMPUTER TO IMG_BUFFER
  * @param r307_address CURRENT MODULE ADDRESS 
@@ -122,6 +576,15 @@ uint8_t UpImage(char r307_address[]);
  */
 uint8_t DownImage(char r307_address[]);
 
+/**
+ * @brief FUNCTION TO START DOWNLOADING AN IMAGE TO IMG_BUFFER, BYTES ARE THEN WRITTEN WITH r307_data_writer_write
+ *
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @param writer INITIALIZED FOR R307_IMAGE_SIZE BYTES IF THE MODULE IS READY ( HOLD r307_link_acquire UNTIL THE LAST BYTE IS WRITTEN )
+ * @return RETURNS RECEIVED CONFIRMATION CODE FROM MODULE
+ */
+uint8_t r307_down_image(char r307_address[], r307_data_writer_t *writer);
+
 /**
  * @brief FUNCTION TO GENERATE CHARACTER FILE FROM IMAGE IN IMAGE BUFFER AND STORE IN CHARBUFFER1/CHARBUFFER2
  *
@@ -156,6 +619,39 @@ uint8_t UpChar(char r307_address[], char buffer_id[]);
  */
 uint8_t DownChar(char r307_address[], char buffer_id[]);
 
+/**
+ * @brief FUNCTION TO UPLOAD CHARACTER FILE/TEMPLATE OF CHARBUFFER1/CHARBUFFER2 & STREAM ITS DATA PACKAGES TO A CALLBACK
+ *
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @param buffer_id BUFFER ID ( CHARACTER FILE BUFFER NUMBER )
+ * @param callback CALLED WITH THE CONTENTS OF EVERY DATA PACKAGE
+ * @param arg USER ARGUMENT PASSED TO THE CALLBACK
+ * @return RETURNS RECEIVED CONFIRMATION CODE FROM MODULE, OR 0x01 IF THE TRANSFER BROKE
+ */
+uint8_t r307_up_char(char r307_address[], char buffer_id[], r307_data_cb_t callback, void *arg);
+
+/**
+ * @brief FUNCTION TO DOWNLOAD A CHARACTER FILE/TEMPLATE FROM A BUFFER TO CHARBUFFER1/CHARBUFFER2
+ *
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @param buffer_id BUFFER ID ( CHARACTER FILE BUFFER NUMBER )
+ * @param data TEMPLATE BYTES
+ * @param length NUMBER OF BYTES IN data
+ * @return RETURNS RECEIVED CONFIRMATION CODE FROM MODULE
+ */
+uint8_t r307_down_char(char r307_address[], char buffer_id[], const uint8_t data[], int length);
+
+/**
+ * @brief FUNCTION TO START DOWNLOADING A CHARACTER FILE/TEMPLATE, BYTES ARE THEN WRITTEN WITH r307_data_writer_write ( E.G. WHILE DECRYPTING )
+ *
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @param buffer_id BUFFER ID ( CHARACTER FILE BUFFER NUMBER )
+ * @param writer INITIALIZED FOR length BYTES IF THE MODULE IS READY ( HOLD r307_link_acquire UNTIL THE LAST BYTE IS WRITTEN )
+ * @param length NUMBER OF TEMPLATE BYTES THAT WILL BE WRITTEN
+ * @return RETURNS RECEIVED CONFIRMATION CODE FROM MODULE
+ */
+uint8_t r307_down_char_begin(char r307_address[], char buffer_id[], r307_data_writer_t *writer, int length);
+
 /**
  * @brief FUNCTION TO STORE TEMPLATE TO SPECIFIED BUFFER AT DESIRED FLASH LOCATION
  *
@@ -218,13 +714,70 @@ uint8_t Search(char r307_address[], char buffer_id[], char start_page[], char pa
  */
 uint8_t GetRandomCode(char r307_address[]);
 
+/**
+ * @brief FUNCTION TO WRITE 32 BYTES TO A PAGE OF THE USER NOTEPAD IN THE MODULE'S FLASH
+ *
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @param page_number NOTEPAD PAGE ( 0 .. 15 )
+ * @param content R307_NOTEPAD_PAGE_SIZE BYTES TO WRITE
+ * @return RETURNS RECEIVED CONFIRMATION CODE FROM MODULE
+ */
+uint8_t WriteNotepad(char r307_address[], char page_number[], const char content[]);
+
+/**
+ * @brief FUNCTION TO READ A PAGE OF THE USER NOTEPAD, CONTENTS ARE IN r307_get_response()->notepad
+ *
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @param page_number NOTEPAD PAGE ( 0 .. 15 )
+ * @return RETURNS RECEIVED CONFIRMATION CODE FROM MODULE
+ */
+uint8_t ReadNotepad(char r307_address[], char page_number[]);
+
+/**
+ * @brief FUNCTION TO SET ONE SYSTEM PARAMETER ( BAUD, SECURITY LEVEL OR DATA PACKET SIZE )
+ *
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @param parameter_number R307_SYS_PARA_BAUD | R307_SYS_PARA_SECURITY | R307_SYS_PARA_PACKET_SIZE
+ * @param content NEW VALUE OF THE PARAMETER
+ * @return RETURNS RECEIVED CONFIRMATION CODE FROM MODULE
+ */
+uint8_t SetSysPara(char r307_address[], char parameter_number[], char content[]);
+
+/**
+ * @brief FUNCTION TO READ WHICH LIBRARY PAGES HOLD A TEMPLATE, BITS ARE IN r307_get_response()->index_table
+ *
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @param index_page INDEX PAGE n COVERS LIBRARY PAGES n x 256 .. n x 256 + 255
+ * @return RETURNS RECEIVED CONFIRMATION CODE FROM MODULE
+ */
+uint8_t ReadIndexTable(char r307_address[], char index_page[]);
+
+/**
+ * @brief FUNCTION TO DETECT FINGER AND STORE IMAGE IN IMAGEBUFFER, REJECTING POOR QUALITY IMAGES ( 0x07 )
+ *
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @return RETURNS RECEIVED CONFIRMATION CODE FROM MODULE
+ */
+uint8_t GetImageEx(char r307_address[]);
+
+/**
+ * @brief FUNCTION TO SEARCH THE LIBRARY LIKE Search WITH THE MODULE'S FASTER 1:N ALGORITHM ( NOT ON EVERY FIRMWARE )
+ *
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @param buffer_id BUFFER ID ( CHARACTER FILE BUFFER NUMBER )
+ * @param start_page START ADDRESS FOR SEARCH OPERATION
+ * @param page_number SEARCHING NUMBER
+ * @return RETURNS RECEIVED CONFIRMATION CODE FROM MODULE
+ */
+uint8_t HighSpeedSearch(char r307_address[], char buffer_id[], char start_page[], char page_number[]);
+
 /**
  * @brief FUNCTION TO PARSE RESPONSES RECEIVED FROM THE MODULE
  * @param instruction_code INSTRUCTION CODE OF THE RECEIVED COMMAND 
  * @param received_package ENTIRE RECEIVED STRING 
  * @return
  */
-void r307_response_parser(char instruction_code[], uint8_t received_package[]);
+void r307_response_parser(char instruction_code, uint8_t received_package[]);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,403 @@
+#include <stdint.h>
+#include <stddef.h>
+#include "string.h"
+
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+
+#include "r307.h"
+#include "r307_backup.h"
+#include "r307_library.h"
+
+#define R307_BACKUP_RECORDS_OFFSET (SPI_FLASH_SEC_SIZE)        //++ Header sector first, records after it ( within a slot )
+#define R307_BACKUP_SLOTS (2)                                   //++ Current backup & the one being written
+
+static const char *R307_BACKUP = "R307_BACKUP";                 //++ Backup TAG
+
+static r307_backup_record_t backup_record;                      //++ The only template held in RAM
+
+typedef struct
+{
+    int offset;
+    uint8_t differs;
+    r307_secure_stream_t *stream;               //++ Encrypted backup : key stream of the record
+} r307_backup_compare_t;
+
+static const esp_partition_t *r307_backup_partition(const r307_backup_config_t *config)
+{
+    const char *label = config->partition_label ? config->partition_label : R307_BACKUP_PARTITION;
+    const esp_partition_t *partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+
+    if(partition == NULL)
+    {
+        ESP_LOGE(R307_BACKUP, "Partition %s not found", label);
+    }
+
+    return partition;
+}
+
+static uint32_t r307_backup_header_crc(const r307_backup_header_t *header)
+{
+    return esp_rom_crc32_le(0, (const uint8_t *)header, offsetof(r307_backup_header_t, crc));
+}
+
+static uint32_t r307_backup_slot_size(const esp_partition_t *partition)
+{
+    return (partition->size / R307_BACKUP_SLOTS) & ~(SPI_FLASH_SEC_SIZE - 1);           //++ Slots start on a sector so each can be erased alone
+}
+
+static esp_err_t r307_backup_read_slot(const esp_partition_t *partition, int slot, r307_backup_header_t *header)
+{
+    if(esp_partition_read(partition, slot * r307_backup_slot_size(partition), header, sizeof(*header)) != ESP_OK)
+    {
+        return ESP_FAIL;
+    }
+    if(header->magic != R307_BACKUP_MAGIC || header->version != R307_BACKUP_VERSION || header->record_size != sizeof(r307_backup_record_t) || header->crc != r307_backup_header_crc(header))
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    return ESP_OK;
+}
+
+static int r307_backup_current_slot(const esp_partition_t *partition, r307_backup_header_t *header)
+{
+    r307_backup_header_t slot_header;
+    int current = -1;
+
+    for(int slot=0; slot<R307_BACKUP_SLOTS; slot++)
+    {
+        if(r307_backup_read_slot(partition, slot, &slot_header) == ESP_OK && (current < 0 || (int32_t)(slot_header.sequence - header->sequence) > 0))
+        {
+            memcpy(header, &slot_header, sizeof(slot_header));
+            current = slot;
+        }
+    }
+
+    return current;                                                                     //++ -1 : No valid backup in either slot
+}
+
+static int r307_backup_fill(const uint8_t data[], int length, void *arg)
+{
+    r307_secure_stream_t *stream = arg;                                                 //++ NULL : Plain backup
+
+    if(backup_record.length + length > R307_TEMPLATE_SIZE)                              //++ Larger than any template, don't overrun the record
+    {
+        return -1;
+    }
+    if(stream)
+    {
+        r307_secure_seal(stream, data, &backup_record.data[backup_record.length], length);  //++ Encrypted as the Data Package arrives
+    }
+    else
+    {
+        memcpy(&backup_record.data[backup_record.length], data, length);
+    }
+    backup_record.length += length;
+
+    return 0;
+}
+
+static int r307_backup_compare(const uint8_t data[], int length, void *arg)
+{
+    r307_backup_compare_t *compare = arg;
+    uint8_t encrypted[64];
+
+    if(compare->offset + length > backup_record.length)
+    {
+        compare->differs = 1;                                                           //++ Keep draining the Data Packages, the link must stay in sync
+    }
+    for(int offset=0; !compare->differs && offset<length; offset+=sizeof(encrypted))
+    {
+        const int chunk_length = (length - offset < (int)sizeof(encrypted)) ? length - offset : (int)sizeof(encrypted);
+        const uint8_t *chunk = &data[offset];
+
+        if(compare->stream)
+        {
+            r307_secure_seal(compare->stream, chunk, encrypted, chunk_length);          //++ Same key stream : equal plain bytes give equal encrypted bytes
+            chunk = encrypted;
+        }
+        compare->differs = memcmp(&backup_record.data[compare->offset + offset], chunk, chunk_length) != 0;
+    }
+    compare->offset += length;
+
+    return 0;
+}
+
+static esp_err_t r307_backup_restore_page(char r307_address[], int page, r307_secure_t *secure, r307_backup_stats_t *backup_stats)
+{
+    char buffer_id[1] = {0x01};
+    char page_id[2] = {page >> 8, page & 0xFF};
+    r307_backup_compare_t compare = {0};
+    r307_secure_stream_t stream;
+    uint8_t tag[R307_SECURE_TAG_SIZE];
+    uint8_t confirmation_code = LoadChar(r307_address, buffer_id, page_id);
+
+    if(!r307_get_response()->received)
+    {
+        backup_stats->failures++;
+        return ESP_ERR_TIMEOUT;
+    }
+    if(confirmation_code == 0x00)                                                       //++ Page occupied, compare it chunk by chunk while it streams
+    {
+        if(secure)
+        {
+            r307_secure_stream_begin(&stream, secure, backup_record.nonce);
+            compare.stream = &stream;
+        }
+        confirmation_code = r307_up_char(r307_address, buffer_id, r307_backup_compare, &compare);
+        if(secure)
+        {
+            r307_secure_seal_end(&stream, tag);                                         //++ Only to wipe the key stream
+        }
+    }
+    if(confirmation_code == 0x00 && !compare.differs && compare.offset == backup_record.length)
+    {
+        backup_stats->skipped++;
+        return ESP_OK;
+    }
+
+    if(secure)
+    {
+        confirmation_code = r307_secure_down_data(secure, r307_address, buffer_id, backup_record.nonce, backup_record.data, backup_record.length, backup_record.tag);
+    }
+    else
+    {
+        confirmation_code = r307_down_char(r307_address, buffer_id, backup_record.data, backup_record.length);
+    }
+    if(confirmation_code == 0x00)
+    {
+        confirmation_code = Store(r307_address, buffer_id, page_id);
+    }
+    if(confirmation_code == 0x00 && r307_get_response()->received)
+    {
+        backup_stats->written++;
+    }
+    else
+    {
+        ESP_LOGW(R307_BACKUP, "Page %d not restored, code 0x%02X", page, confirmation_code);
+        backup_stats->failures++;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t r307_backup_read_header(const r307_backup_config_t *config, r307_backup_header_t *header)
+{
+    const esp_partition_t *partition = r307_backup_partition(config);
+
+    if(partition == NULL || r307_backup_current_slot(partition, header) < 0)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t r307_backup_save(const r307_backup_config_t *config, r307_backup_stats_t *stats)
+{
+    char buffer_id[1] = {0x01};
+    char r307_address[4];
+    uint8_t occupied[R307_BACKUP_MAX_PAGES / 8];
+    r307_backup_header_t header;
+    r307_backup_stats_t backup_stats = {0};
+    const esp_partition_t *partition = r307_backup_partition(config);
+    int current_slot = -1;
+    uint32_t slot_offset = 0;
+    uint32_t erased_end = R307_BACKUP_RECORDS_OFFSET;
+    uint32_t sequence = 1;
+    esp_err_t err = ESP_OK;
+
+    if(partition == NULL)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if(config->library_size == 0 || config->library_size > R307_BACKUP_MAX_PAGES)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    current_slot = r307_backup_current_slot(partition, &header);
+    if(current_slot >= 0)
+    {
+        sequence = header.sequence + 1;
+    }
+    slot_offset = (current_slot == 0) ? r307_backup_slot_size(partition) : 0;           //++ Write the other slot, the current backup stays valid until the new header is in
+
+    memcpy(r307_address, config->r307_address, 4);
+    memset(&header, 0, sizeof(header));
+    header.magic = R307_BACKUP_MAGIC;
+    header.version = R307_BACKUP_VERSION;
+    header.record_size = sizeof(r307_backup_record_t);
+    header.library_size = config->library_size;
+    header.sequence = sequence;
+    header.encrypted = (config->secure != NULL);
+
+    if(r307_library_scan(r307_address, config->library_size, occupied) != 0x00)        //++ Scan before erasing, a dead link must not destroy the last backup
+    {
+        ESP_LOGE(R307_BACKUP, "Occupancy scan failed, backup not started");
+        return ESP_ERR_TIMEOUT;
+    }
+
+    err = esp_partition_erase_range(partition, slot_offset, SPI_FLASH_SEC_SIZE);        //++ Invalidate the older backup of this slot before overwriting its records
+    for(int page=0; err == ESP_OK && page<config->library_size; page++)
+    {
+        char page_id[2] = {page >> 8, page & 0xFF};
+        r307_secure_stream_t stream;
+        uint8_t confirmation_code = 0;
+        uint8_t received = 0;
+
+        if(!(occupied[page / 8] & (1 << (page % 8))))                                  //++ Empty page, no LoadChar needed
+        {
+            backup_stats.scanned++;
+            continue;
+        }
+        r307_link_acquire();                                                            //++ LoadChar & UpChar of one page must not be split by another task
+        confirmation_code = LoadChar(r307_address, buffer_id, page_id);
+        received = r307_get_response()->received;
+        backup_record.page_id = page;
+        backup_record.length = 0;
+        memset(backup_record.nonce, 0, sizeof(backup_record.nonce));
+        memset(backup_record.tag, 0, sizeof(backup_record.tag));
+        if(received && confirmation_code == 0x00 && config->secure)
+        {
+            r307_secure_seal_begin(&stream, config->secure, backup_record.nonce);
+            confirmation_code = r307_up_char(r307_address, buffer_id, r307_backup_fill, &stream);
+            r307_secure_seal_end(&stream, backup_record.tag);
+        }
+        else if(received && confirmation_code == 0x00)
+        {
+            confirmation_code = r307_up_char(r307_address, buffer_id, r307_backup_fill, NULL);
+        }
+        r307_link_release();
+
+        backup_stats.scanned++;
+        if(!received)
+        {
+            backup_stats.failures++;
+            err = ESP_ERR_TIMEOUT;
+            break;
+        }
+        if(confirmation_code == 0x0C)                                                   //++ No valid template on this page
+        {
+            continue;
+        }
+        if(confirmation_code != 0x00 || backup_record.length == 0)
+        {
+            ESP_LOGW(R307_BACKUP, "Page %d not saved, code 0x%02X", page, confirmation_code);
+            backup_stats.failures++;
+            continue;
+        }
+        backup_record.crc = esp_rom_crc32_le(0, backup_record.data, backup_record.length);
+
+        const uint32_t offset = R307_BACKUP_RECORDS_OFFSET + header.record_count * sizeof(r307_backup_record_t);
+        if(offset + sizeof(r307_backup_record_t) > r307_backup_slot_size(partition))
+        {
+            ESP_LOGE(R307_BACKUP, "Slot full after %d records", header.record_count);
+            err = ESP_ERR_INVALID_SIZE;
+            break;
+        }
+        while(err == ESP_OK && erased_end < offset + sizeof(r307_backup_record_t))     //++ Erase sectors only as records reach them
+        {
+            err = esp_partition_erase_range(partition, slot_offset + erased_end, SPI_FLASH_SEC_SIZE);
+            erased_end += SPI_FLASH_SEC_SIZE;
+        }
+        if(err == ESP_OK)
+        {
+            err = esp_partition_write(partition, slot_offset + offset, &backup_record, sizeof(backup_record));
+        }
+        if(err == ESP_OK)
+        {
+            header.page_bitmap[page / 8] |= 1 << (page % 8);
+            header.record_count++;
+            backup_stats.saved++;
+        }
+    }
+
+    if(err == ESP_OK && backup_stats.failures)                                          //++ Incomplete, keep the previous backup current
+    {
+        err = ESP_FAIL;
+    }
+    if(err == ESP_OK)
+    {
+        header.crc = r307_backup_header_crc(&header);
+        err = esp_partition_write(partition, slot_offset, &header, sizeof(header));     //++ Header last : commits the backup
+    }
+    if(err == ESP_OK)
+    {
+        ESP_LOGI(R307_BACKUP, "Saved %d templates of %d pages to slot %d", backup_stats.saved, backup_stats.scanned, slot_offset ? 1 : 0);
+    }
+    else
+    {
+        ESP_LOGE(R307_BACKUP, "Backup aborted, %s", esp_err_to_name(err));
+    }
+    if(stats)
+    {
+        *stats = backup_stats;
+    }
+
+    return err;
+}
+
+esp_err_t r307_backup_restore(const r307_backup_config_t *config, r307_backup_stats_t *stats)
+{
+    char r307_address[4];
+    r307_backup_header_t header;
+    r307_backup_stats_t backup_stats = {0};
+    const esp_partition_t *partition = r307_backup_partition(config);
+    const int current_slot = partition ? r307_backup_current_slot(partition, &header) : -1;
+    int record_index = 0;
+    esp_err_t err = ESP_OK;
+
+    if(current_slot < 0)
+    {
+        ESP_LOGE(R307_BACKUP, "No valid backup to restore");
+        return ESP_ERR_NOT_FOUND;
+    }
+    if(header.encrypted && config->secure == NULL)
+    {
+        ESP_LOGE(R307_BACKUP, "Backup is encrypted, no key given");
+        return ESP_ERR_INVALID_ARG;
+    }
+    const uint32_t slot_offset = current_slot * r307_backup_slot_size(partition);
+
+    memcpy(r307_address, config->r307_address, 4);
+    for(int page=0; page<R307_BACKUP_MAX_PAGES && record_index<header.record_count; page++)
+    {
+        if(!(header.page_bitmap[page / 8] & (1 << (page % 8))))
+        {
+            continue;
+        }
+
+        const uint32_t offset = slot_offset + R307_BACKUP_RECORDS_OFFSET + record_index * sizeof(r307_backup_record_t);
+        record_index++;
+        backup_stats.scanned++;
+        if(esp_partition_read(partition, offset, &backup_record, sizeof(backup_record)) != ESP_OK || backup_record.page_id != page || backup_record.length > R307_TEMPLATE_SIZE || backup_record.crc != esp_rom_crc32_le(0, backup_record.data, backup_record.length))
+        {
+            ESP_LOGW(R307_BACKUP, "Record of page %d is corrupt", page);
+            backup_stats.failures++;
+            continue;
+        }
+
+        r307_link_acquire();                                                            //++ Compare & rewrite of one page must not be split by another task
+        err = r307_backup_restore_page(r307_address, page, header.encrypted ? config->secure : NULL, &backup_stats);
+        r307_link_release();
+        if(err != ESP_OK)
+        {
+            break;
+        }
+    }
+
+    if(err == ESP_OK && backup_stats.failures)
+    {
+        err = ESP_FAIL;
+    }
+    ESP_LOGI(R307_BACKUP, "Restored %d pages, %d already present, %d failed", backup_stats.written, backup_stats.skipped, backup_stats.failures);
+    if(stats)
+    {
+        *stats = backup_stats;
+    }
+
+    return err;
+}
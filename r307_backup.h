@@ -0,0 +1,104 @@
+#include <stdint.h>
+#include "esp_err.h"
+
+#include "r307.h"
+#include "r307_secure.h"
+
+#ifndef r307_backup_H
+#define r307_backup_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define R307_BACKUP_PARTITION "r307bak"        //++ Default label of the backup data partition
+#define R307_BACKUP_MAX_PAGES (1024)           //++ Pages covered by the header bitmap
+#define R307_BACKUP_MAGIC (0x4B423352)         //++ "R3BK"
+#define R307_BACKUP_VERSION (4)                //++ 4 : Encrypted records carry an HMAC tag
+
+/**
+ * @brief HEADER OF A BACKUP, KEPT IN THE FIRST SECTOR OF ITS SLOT & WRITTEN LAST SO AN INTERRUPTED BACKUP IS NEVER VALID
+ *        THE PARTITION HOLDS TWO SLOTS, A NEW BACKUP GOES TO THE OTHER SLOT AND THE PREVIOUS ONE STAYS VALID UNTIL IT IS COMMITTED
+ */
+typedef struct
+{
+    uint32_t magic;                                             //++ R307_BACKUP_MAGIC
+    uint16_t version;                                           //++ R307_BACKUP_VERSION
+    uint16_t record_size;                                       //++ Bytes of one record, records start at the second sector
+    uint16_t library_size;                                      //++ Library size of the module the backup was taken from
+    uint16_t record_count;                                      //++ Number of records ( bits set in page_bitmap )
+    uint16_t encrypted;                                         //++ 1 : Records were sealed with r307_secure, restore needs the same key
+    uint16_t reserved;
+    uint32_t sequence;                                          //++ Incremented by every backup, the slot with the higher one is current
+    uint8_t page_bitmap[R307_BACKUP_MAX_PAGES / 8];             //++ Bit n set : page n has a record, records are in page order
+    uint32_t crc;                                               //++ CRC32 of everything above
+} r307_backup_header_t;
+
+/**
+ * @brief ONE FIXED-SIZE TEMPLATE RECORD
+ */
+typedef struct
+{
+    uint16_t page_id;                                           //++ Library page the template was loaded from
+    uint16_t length;                                            //++ Valid bytes in data
+    uint32_t crc;                                               //++ CRC32 of data[0 .. length - 1] as stored ( encrypted or not )
+    uint8_t nonce[R307_SECURE_NONCE_SIZE];                      //++ Encrypted backup : counter block of this record
+    uint8_t tag[R307_SECURE_TAG_SIZE];                          //++ Encrypted backup : HMAC-SHA256 of nonce & encrypted data
+    uint8_t data[R307_TEMPLATE_SIZE];
+} r307_backup_record_t;
+
+/**
+ * @brief BACKUP / RESTORE SETTINGS
+ */
+typedef struct
+{
+    const char *partition_label;                                //++ NULL : R307_BACKUP_PARTITION
+    char r307_address[4];                                       //++ Current Module Address
+    uint16_t library_size;                                      //++ Pages to scan when saving ( at most R307_BACKUP_MAX_PAGES )
+    r307_secure_t *secure;                                      //++ NULL : Plain records, else records are encrypted as they are uploaded
+} r307_backup_config_t;
+
+/**
+ * @brief COUNTERS OF THE LAST BACKUP OR RESTORE
+ */
+typedef struct
+{
+    uint16_t scanned;                                           //++ Pages looked at
+    uint16_t saved;                                             //++ Records written to flash ( backup )
+    uint16_t written;                                           //++ Pages downloaded & stored in the module ( restore )
+    uint16_t skipped;                                           //++ Pages already identical in the module ( restore )
+    uint16_t failures;                                          //++ Pages that failed ( bad record CRC or module error )
+} r307_backup_stats_t;
+
+/**
+ * @brief FUNCTION TO SAVE EVERY OCCUPIED TEMPLATE OF THE MODULE TO THE BACKUP PARTITION, ONE PAGE AT A TIME
+ *
+ * @param config BACKUP SETTINGS
+ * @param stats FILLED WITH THE COUNTERS OF THIS BACKUP ( MAY BE NULL )
+ * @return RETURNS ESP_OK WHEN THE BACKUP WAS COMMITTED, OTHERWISE THE PREVIOUS BACKUP STAYS CURRENT ( ESP_FAIL IF A PAGE COULD NOT BE SAVED )
+ */
+esp_err_t r307_backup_save(const r307_backup_config_t *config, r307_backup_stats_t *stats);
+
+/**
+ * @brief FUNCTION TO RESTORE THE BACKUP, ONLY PAGES WHOSE TEMPLATE DIFFERS IN THE MODULE ARE WRITTEN
+ *
+ * @param config BACKUP SETTINGS ( library_size IS NOT USED, secure IS NEEDED FOR AN ENCRYPTED BACKUP )
+ * @param stats FILLED WITH THE COUNTERS OF THIS RESTORE ( MAY BE NULL )
+ * @return RETURNS ESP_OK WHEN EVERY RECORD WAS RESTORED OR ALREADY PRESENT, ESP_ERR_INVALID_ARG IF THE BACKUP IS ENCRYPTED & secure IS NULL
+ */
+esp_err_t r307_backup_restore(const r307_backup_config_t *config, r307_backup_stats_t *stats);
+
+/**
+ * @brief FUNCTION TO READ THE HEADER OF THE CURRENT BACKUP IN THE PARTITION
+ *
+ * @param config BACKUP SETTINGS
+ * @param header FILLED WITH THE HEADER
+ * @return RETURNS ESP_OK IF A VALID BACKUP IS PRESENT, ESP_ERR_NOT_FOUND OTHERWISE
+ */
+esp_err_t r307_backup_read_header(const r307_backup_config_t *config, r307_backup_header_t *header);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // r307_backup_H
@@ -0,0 +1,137 @@
+#include <stdint.h>
+#include "string.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
+
+#include "driver/uart.h"
+
+#include "r307.h"
+#include "r307_boot.h"
+
+#define R307_BOOT_INITIAL_BACKOFF_MS (50)       //++ Default first retry delay
+#define R307_BOOT_MAX_BACKOFF_MS (800)          //++ Default retry delay cap
+#define R307_BOOT_TIMEOUT_MS (5000)             //++ Default bring-up timeout
+#define R307_BOOT_STACK_SIZE (4096)             //++ Stack size of the boot task
+#define R307_BOOT_PRIORITY (5)                  //++ Priority of the boot task
+
+static const char *R307_BOOT = "R307_BOOT";     //++ Boot TAG
+
+static r307_boot_config_t boot_config;          //++ Active bring-up configuration
+static r307_boot_stats_t boot_stats;            //++ Bring-up statistics
+static EventGroupHandle_t boot_event_group;     //++ Ready / Failed event bits
+static int64_t boot_start_time;                 //++ Time r307_boot_start was called
+
+static void r307_boot_task(void *arg)
+{
+    uint32_t backoff_ms = boot_config.initial_backoff_ms;
+    const int64_t deadline = boot_start_time + (int64_t)boot_config.timeout_ms * 1000;
+    uint8_t confirmation_code = 0;
+    uint8_t answered = 0;
+
+    r307_init();
+
+    while(esp_timer_get_time() < deadline)
+    {
+        boot_stats.attempts++;
+        r307_link_acquire();
+        r307_flush_input();                                                             //++ Drop the 0x55 power-on byte & any noise from power-up
+        confirmation_code = r307_session_verify(boot_config.session);
+        answered = r307_get_response()->received;
+        r307_link_release();
+        if(answered)
+        {
+            break;
+        }
+
+        vTaskDelay(backoff_ms / portTICK_PERIOD_MS);                                    //++ Module still powering up, back off
+        backoff_ms = backoff_ms * 2 > boot_config.max_backoff_ms ? boot_config.max_backoff_ms : backoff_ms * 2;
+    }
+
+    if(answered && confirmation_code == 0x00)
+    {
+        confirmation_code = r307_session_read_sys_para(boot_config.session);
+    }
+    if(answered && confirmation_code == 0x00 && boot_config.packet_size)
+    {
+        confirmation_code = r307_session_negotiate_packet_size(boot_config.session, boot_config.packet_size);
+    }
+    if(answered && confirmation_code == 0x00 && boot_config.read_template_number)
+    {
+        uint16_t template_number = 0;
+        confirmation_code = r307_session_template_number(boot_config.session, &template_number);
+    }
+
+    if(answered && confirmation_code == 0x00)
+    {
+        boot_stats.ready_time_us = esp_timer_get_time();
+        boot_stats.bring_up_us = boot_stats.ready_time_us - boot_start_time;
+        ESP_LOGI(R307_BOOT, "Module ready after %u attempts, %lld us", (unsigned)boot_stats.attempts, (long long)boot_stats.bring_up_us);
+        xEventGroupSetBits(boot_event_group, R307_BOOT_READY_BIT);
+    }
+    else
+    {
+        ESP_LOGE(R307_BOOT, "Module bring-up failed with code 0x%02X", confirmation_code);
+        xEventGroupSetBits(boot_event_group, R307_BOOT_FAILED_BIT);
+    }
+
+    vTaskDelete(NULL);
+}
+
+esp_err_t r307_boot_start(const r307_boot_config_t *config)
+{
+    if(config == NULL || config->session == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memcpy(&boot_config, config, sizeof(boot_config));
+    memset(&boot_stats, 0, sizeof(boot_stats));
+    boot_config.initial_backoff_ms = boot_config.initial_backoff_ms ? boot_config.initial_backoff_ms : R307_BOOT_INITIAL_BACKOFF_MS;
+    boot_config.max_backoff_ms = boot_config.max_backoff_ms ? boot_config.max_backoff_ms : R307_BOOT_MAX_BACKOFF_MS;
+    boot_config.timeout_ms = boot_config.timeout_ms ? boot_config.timeout_ms : R307_BOOT_TIMEOUT_MS;
+
+    if(boot_event_group == NULL)
+    {
+        boot_event_group = xEventGroupCreate();
+        if(boot_event_group == NULL)
+        {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    xEventGroupClearBits(boot_event_group, R307_BOOT_READY_BIT | R307_BOOT_FAILED_BIT);
+
+    boot_start_time = esp_timer_get_time();
+    if(xTaskCreate(r307_boot_task, "r307_boot", R307_BOOT_STACK_SIZE, NULL, R307_BOOT_PRIORITY, NULL) != pdPASS)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+
+    return ESP_OK;
+}
+
+EventGroupHandle_t r307_boot_event_group(void)
+{
+    return boot_event_group;
+}
+
+uint8_t r307_boot_wait(uint32_t timeout_ms)
+{
+    if(boot_event_group == NULL)
+    {
+        return 0;
+    }
+
+    const EventBits_t bits = xEventGroupWaitBits(boot_event_group, R307_BOOT_READY_BIT | R307_BOOT_FAILED_BIT, pdFALSE, pdFALSE, timeout_ms / portTICK_PERIOD_MS);
+
+    return (bits & R307_BOOT_READY_BIT) ? 1 : 0;
+}
+
+void r307_boot_get_stats(r307_boot_stats_t *stats)
+{
+    memcpy(stats, &boot_stats, sizeof(*stats));
+}
@@ -0,0 +1,78 @@
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+
+#include "r307_session.h"
+
+#ifndef r307_boot_H
+#define r307_boot_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define R307_BOOT_READY_BIT (1 << 0)            //++ Set once handshake & system parameters are cached
+#define R307_BOOT_FAILED_BIT (1 << 1)           //++ Set if the module did not answer before the boot timeout
+
+/**
+ * @brief CONFIGURATION OF THE BACKGROUND SENSOR BRING-UP
+ */
+typedef struct
+{
+    r307_session_t *session;                //++ Session to verify & fill, owned by the boot task until an event bit is set
+    uint32_t initial_backoff_ms;            //++ First retry delay while the module is powering up ( 0 : Default )
+    uint32_t max_backoff_ms;                //++ Retry delay cap ( 0 : Default )
+    uint32_t timeout_ms;                    //++ Give up and set R307_BOOT_FAILED_BIT after this time ( 0 : Default )
+    uint8_t read_template_number;           //++ 1 : Also cache TempleteNum before signalling ready
+    uint16_t packet_size;                   //++ Data Packet Size to switch to before signalling ready ( 0 : Keep the module's )
+} r307_boot_config_t;
+
+/**
+ * @brief BRING-UP STATISTICS
+ */
+typedef struct
+{
+    uint32_t attempts;                      //++ Handshake attempts until the module answered
+    int64_t ready_time_us;                  //++ Time since ESP32 boot when the module became ready
+    int64_t bring_up_us;                    //++ Time from r307_boot_start to ready
+} r307_boot_stats_t;
+
+/**
+ * @brief FUNCTION TO START UART, HANDSHAKE & SYSTEM PARAMETER READ IN A BACKGROUND TASK
+ *
+ * @param config SESSION & RETRY PARAMETERS
+ * @return RETURNS ESP_OK IF THE BOOT TASK WAS STARTED
+ */
+esp_err_t r307_boot_start(const r307_boot_config_t *config);
+
+/**
+ * @brief FUNCTION TO GET THE EVENT GROUP HOLDING R307_BOOT_READY_BIT & R307_BOOT_FAILED_BIT
+ *
+ * @return RETURNS EVENT GROUP HANDLE ( NULL BEFORE r307_boot_start )
+ */
+EventGroupHandle_t r307_boot_event_group(void);
+
+/**
+ * @brief FUNCTION TO WAIT UNTIL THE MODULE IS READY OR THE BRING-UP FAILED
+ *
+ * @param timeout_ms MAXIMUM WAITING TIME
+ * @return RETURNS 1 IF THE MODULE IS READY, 0 OTHERWISE
+ */
+uint8_t r307_boot_wait(uint32_t timeout_ms);
+
+/**
+ * @brief FUNCTION TO READ THE BRING-UP STATISTICS
+ *
+ * @param stats FILLED WITH THE CURRENT STATISTICS
+ * @return
+ */
+void r307_boot_get_stats(r307_boot_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // r307_boot_H
@@ -0,0 +1,221 @@
+#include <stdint.h>
+#include "string.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "r307.h"
+#include "r307_usermap.h"
+#include "r307_enroll.h"
+
+static const char *R307_ENROLL = "R307_ENROLL"; //++ Enroll TAG
+
+static uint8_t enroll_samples[R307_ENROLL_MAX_SAMPLES][R307_TEMPLATE_SIZE];             //++ Character files of the captured samples
+static int enroll_lengths[R307_ENROLL_MAX_SAMPLES];
+static uint16_t enroll_scores[R307_ENROLL_MAX_SAMPLES][R307_ENROLL_MAX_SAMPLES];        //++ Match Score of every pair i < j
+
+static int r307_enroll_receive(const uint8_t data[], int length, void *arg)
+{
+    const int sample = (int)(intptr_t)arg;
+
+    if(enroll_lengths[sample] + length > R307_TEMPLATE_SIZE)
+    {
+        return -1;
+    }
+    memcpy(&enroll_samples[sample][enroll_lengths[sample]], data, length);
+    enroll_lengths[sample] += length;
+
+    return 0;
+}
+
+static void r307_enroll_prompt(const r307_enroll_config_t *config, r307_enroll_prompt_t prompt, int sample)
+{
+    if(config->prompt)
+    {
+        config->prompt(prompt, sample, config->prompt_arg);
+    }
+}
+
+static uint8_t r307_enroll_wait_finger(const r307_enroll_config_t *config, uint8_t present)
+{
+    const int64_t deadline = esp_timer_get_time() + (int64_t)config->finger_timeout_ms * 1000;
+    uint8_t confirmation_code = 0;
+
+    do
+    {
+        r307_link_acquire();                                                            //++ Released between polls, live identify gets in while the user moves
+        confirmation_code = GenImg((char *)config->r307_address);
+        if(r307_get_response()->received && (present ? confirmation_code == 0x00 : confirmation_code == 0x02))
+        {
+            if(!present)
+            {
+                r307_link_release();
+            }
+            return 0x00;                                                                //++ 0x00 : Image taken ( link kept for Img2Tz ), 0x02 : No finger on the sensor
+        }
+        r307_link_release();
+    } while(esp_timer_get_time() < deadline);
+
+    return present ? 0x02 : 0x01;
+}
+
+static uint8_t r307_enroll_capture(const r307_enroll_config_t *config, int sample)
+{
+    char buffer_id[1] = {0x01};
+    uint8_t confirmation_code = 0;
+
+    r307_enroll_prompt(config, R307_ENROLL_PLACE_FINGER, sample);
+    confirmation_code = r307_enroll_wait_finger(config, 1);
+    if(confirmation_code == 0x00)                                                       //++ Link held since the image was taken
+    {
+        confirmation_code = Img2Tz((char *)config->r307_address, buffer_id);
+        if(confirmation_code == 0x00)
+        {
+            enroll_lengths[sample] = 0;
+            confirmation_code = r307_up_char((char *)config->r307_address, buffer_id, r307_enroll_receive, (void *)(intptr_t)sample);
+        }
+        r307_link_release();
+    }
+    r307_enroll_prompt(config, R307_ENROLL_REMOVE_FINGER, sample);
+    if(r307_enroll_wait_finger(config, 0) != 0x00)
+    {
+        ESP_LOGW(R307_ENROLL, "Finger not lifted after sample %d", sample);
+    }
+
+    return confirmation_code;
+}
+
+static uint8_t r307_enroll_load(const r307_enroll_config_t *config, char buffer_id, int sample)
+{
+    char buffer[1] = {buffer_id};
+
+    return r307_down_char((char *)config->r307_address, buffer, enroll_samples[sample], enroll_lengths[sample]);
+}
+
+uint8_t r307_enroll(const r307_enroll_config_t *config, r307_usermap_t *map, r307_enroll_result_t *result)
+{
+    const int samples = config->samples > R307_ENROLL_MAX_SAMPLES ? R307_ENROLL_MAX_SAMPLES : config->samples;
+    const int templates = config->templates > R307_ENROLL_MAX_TEMPLATES ? R307_ENROLL_MAX_TEMPLATES : config->templates;
+    const int64_t start_time = esp_timer_get_time();
+    char buffer_id[1] = {0x01};
+    uint8_t used[R307_ENROLL_MAX_SAMPLES] = {0};
+    uint8_t confirmation_code = 0x00;
+    int attempts = 0;
+
+    memset(result, 0, sizeof(*result));
+    memset(enroll_scores, 0, sizeof(enroll_scores));                                    //++ Samples are kept in RAM, the link is only held for one step at a time
+
+    while(result->samples < samples && attempts < 2 * samples)                          //++ A poor capture is retaken, within bounds
+    {
+        attempts++;
+        confirmation_code = r307_enroll_capture(config, result->samples);
+        if(confirmation_code == 0x00)
+        {
+            result->samples++;
+        }
+        else
+        {
+            ESP_LOGW(R307_ENROLL, "Sample %d rejected, code 0x%02X", result->samples, confirmation_code);
+        }
+    }
+    if(result->samples < 2)
+    {
+        result->confirmation_code = confirmation_code ? confirmation_code : 0x0A;
+        return result->confirmation_code;
+    }
+
+    for(int i=0; i<result->samples; i++)                                                //++ Score every pair
+    {
+        for(int j=i+1; j<result->samples; j++)
+        {
+            r307_link_acquire();                                                        //++ Another task may have used the CharBuffers since the last pair
+            confirmation_code = r307_enroll_load(config, 0x01, i);
+            if(confirmation_code != 0x00)
+            {
+                r307_link_release();
+                ESP_LOGW(R307_ENROLL, "Sample %d not downloaded, code 0x%02X, row skipped", i, confirmation_code);
+                break;                                                                  //++ Scores of this row stay 0
+            }
+            confirmation_code = r307_enroll_load(config, 0x02, j);
+            if(confirmation_code == 0x00)
+            {
+                confirmation_code = Match((char *)config->r307_address);
+            }
+            if(r307_get_response()->received && (confirmation_code == 0x00 || confirmation_code == 0x08))
+            {
+                enroll_scores[i][j] = (confirmation_code == 0x00) ? r307_get_response()->match_score : 0;
+            }
+            r307_link_release();
+        }
+    }
+
+    confirmation_code = 0x0A;                                                           //++ Fail to combine, unless a pair qualifies
+    while(result->templates < templates)
+    {
+        int best_i = -1;
+        int best_j = -1;
+        uint16_t page_id = 0;
+
+        for(int i=0; i<result->samples; i++)                                            //++ Most consistent pair of samples not used yet
+        {
+            for(int j=i+1; j<result->samples; j++)
+            {
+                if(!used[i] && !used[j] && enroll_scores[i][j] >= config->min_pair_score && (best_i < 0 || enroll_scores[i][j] > enroll_scores[best_i][best_j]))
+                {
+                    best_i = i;
+                    best_j = j;
+                }
+            }
+        }
+        if(best_i < 0)
+        {
+            break;
+        }
+        used[best_i] = 1;
+        used[best_j] = 1;
+        if(result->templates == 0)
+        {
+            result->best_score = enroll_scores[best_i][best_j];
+        }
+
+        if(r307_usermap_free_page(map, config->library_size, &page_id) != ESP_OK)
+        {
+            confirmation_code = 0x1F;
+            break;
+        }
+        r307_link_acquire();                                                            //++ DownChar pair, RegModel & Store form one step
+        confirmation_code = r307_enroll_load(config, 0x01, best_i);
+        if(confirmation_code == 0x00)
+        {
+            confirmation_code = r307_enroll_load(config, 0x02, best_j);
+        }
+        if(confirmation_code == 0x00)
+        {
+            confirmation_code = RegModel((char *)config->r307_address);                 //++ Merged template lands in CharBuffer1
+        }
+        if(confirmation_code == 0x00 && r307_usermap_store(map, (char *)config->r307_address, config->user_id, buffer_id, page_id) != ESP_OK)
+        {
+            confirmation_code = 0x18;                                                   //++ Error when writing flash
+        }
+        r307_link_release();
+        if(confirmation_code != 0x00)
+        {
+            ESP_LOGW(R307_ENROLL, "Pair %d/%d not stored, code 0x%02X", best_i, best_j, confirmation_code);
+            continue;
+        }
+
+        result->page_ids[result->templates] = page_id;
+        result->pair_scores[result->templates] = enroll_scores[best_i][best_j];
+        result->templates++;
+    }
+
+    if(result->templates)
+    {
+        confirmation_code = 0x00;
+    }
+    result->confirmation_code = confirmation_code;
+    result->latency_us = esp_timer_get_time() - start_time;
+    ESP_LOGI(R307_ENROLL, "User %lu enrolled with %d templates from %d samples, best score %d", (unsigned long)config->user_id, result->templates, result->samples, result->best_score);
+
+    return confirmation_code;
+}
@@ -0,0 +1,69 @@
+#include <stdint.h>
+
+#include "r307.h"
+#include "r307_usermap.h"
+
+#ifndef r307_enroll_H
+#define r307_enroll_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define R307_ENROLL_MAX_SAMPLES (5)             //++ Samples held in RAM ( one template each )
+#define R307_ENROLL_MAX_TEMPLATES (R307_ENROLL_MAX_SAMPLES / 2)    //++ Every stored template is merged from two distinct samples
+
+/**
+ * @brief WHAT THE USER HAS TO DO NEXT
+ */
+typedef enum
+{
+    R307_ENROLL_PLACE_FINGER = 0,           //++ Waiting for the finger ( sample number given )
+    R307_ENROLL_REMOVE_FINGER,              //++ Sample taken, finger has to be lifted before the next one
+} r307_enroll_prompt_t;
+
+/**
+ * @brief ENROLLMENT SETTINGS
+ */
+typedef struct
+{
+    char r307_address[4];                                       //++ Current Module Address
+    uint32_t user_id;                                           //++ Application User ID the templates are mapped to
+    uint16_t library_size;                                      //++ Pages free pages are taken from
+    uint8_t samples;                                            //++ Captures to take ( 2 .. R307_ENROLL_MAX_SAMPLES )
+    uint8_t templates;                                          //++ Templates to store for the finger ( 1 .. R307_ENROLL_MAX_TEMPLATES )
+    uint16_t min_pair_score;                                    //++ Match Score a pair needs to be merged into a template
+    uint32_t finger_timeout_ms;                                 //++ Max wait for the finger to be placed or lifted
+    void (*prompt)(r307_enroll_prompt_t prompt, int sample, void *arg); //++ Optional, tells the user when to place / lift the finger
+    void *prompt_arg;
+} r307_enroll_config_t;
+
+/**
+ * @brief RESULT OF ONE ENROLLMENT
+ */
+typedef struct
+{
+    uint8_t confirmation_code;                                  //++ 0x00 : At least one template stored
+    uint8_t samples;                                            //++ Samples captured
+    uint8_t templates;                                          //++ Templates stored
+    uint16_t best_score;                                        //++ Match Score of the most consistent pair
+    uint16_t page_ids[R307_ENROLL_MAX_TEMPLATES];               //++ Pages the templates were stored to, best pair first
+    uint16_t pair_scores[R307_ENROLL_MAX_TEMPLATES];            //++ Match Score of the pair behind each template
+    int64_t latency_us;                                         //++ Time taken by the whole enrollment in microseconds
+} r307_enroll_result_t;
+
+/**
+ * @brief FUNCTION TO ENROLL A FINGER FROM THE MOST CONSISTENT OF N SAMPLES & STORE SEVERAL TEMPLATES FOR IT
+ *
+ * @param config ENROLLMENT SETTINGS
+ * @param map MAPPING STORE THE TEMPLATES ARE STORED THROUGH ( GIVES FREE PAGES & MAPS THEM TO config->user_id )
+ * @param result FILLED WITH PAGES, SCORES & LATENCY
+ * @return RETURNS 0x00 ON SUCCESS, 0x0A IF NO PAIR REACHED min_pair_score, 0x1F IF THE LIBRARY IS FULL, ELSE CODE OF THE FAILED STEP
+ */
+uint8_t r307_enroll(const r307_enroll_config_t *config, r307_usermap_t *map, r307_enroll_result_t *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // r307_enroll_H
@@ -0,0 +1,308 @@
+#include <stdint.h>
+#include "string.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "r307.h"
+#include "r307_flow.h"
+
+static const char *R307_FLOW = "R307_FLOW";     //++ Flow TAG
+
+static r307_search_mode_t flow_search_mode = R307_SEARCH_NORMAL;
+static uint8_t flow_high_speed_rejected;        //++ R307_SEARCH_AUTO : Module answered Search but not HighSpeedSearch
+static uint32_t flow_repeat_window_ms;          //++ 0 : Repeat touches are searched like any other
+static uint16_t flow_repeat_min_score;
+
+static struct
+{
+    uint8_t valid;
+    char buffer_id;                             //++ CharBuffer holding the character file of the cached finger
+    uint32_t image_generation;                  //++ Image it was generated from, to detect it being overwritten
+    uint32_t library_generation;                //++ Library it was found in, a changed page may no longer hold the finger
+    uint16_t page_id;
+    uint16_t match_score;
+    int64_t found_us;                           //++ Time the finger was found by Search
+} flow_repeat;
+
+void r307_flow_set_search_mode(r307_search_mode_t mode)
+{
+    flow_search_mode = mode;
+    flow_high_speed_rejected = 0;
+}
+
+void r307_flow_set_repeat_window(uint32_t window_ms, uint16_t min_score)
+{
+    flow_repeat_window_ms = window_ms;
+    flow_repeat_min_score = min_score;
+    flow_repeat.valid = 0;
+}
+
+void r307_flow_clear_repeat(void)
+{
+    flow_repeat.valid = 0;
+}
+
+static uint8_t r307_flow_repeat_usable(int64_t now)
+{
+    r307_char_buffer_t state;
+
+    if(!flow_repeat.valid || now - flow_repeat.found_us > (int64_t)flow_repeat_window_ms * 1000)
+    {
+        return 0;
+    }
+    if(flow_repeat.library_generation != r307_get_library_generation())                 //++ Page deleted, overwritten or library emptied since the Search
+    {
+        flow_repeat.valid = 0;
+        return 0;
+    }
+    r307_get_char_buffer(flow_repeat.buffer_id, &state);                                //++ Another flow may have reused the buffer since
+
+    return state.source == R307_CHAR_IMAGE && state.image_generation == flow_repeat.image_generation;
+}
+
+static uint8_t r307_flow_search(char r307_address[], char buffer_id[], char start_page[], char page_number[], uint8_t *search_instruction)
+{
+    uint8_t confirmation_code = 0;
+
+    if(flow_search_mode == R307_SEARCH_NORMAL || (flow_search_mode == R307_SEARCH_AUTO && flow_high_speed_rejected))
+    {
+        *search_instruction = 0x04;
+        return Search(r307_address, buffer_id, start_page, page_number);
+    }
+
+    *search_instruction = 0x1B;
+    confirmation_code = HighSpeedSearch(r307_address, buffer_id, start_page, page_number);
+    if(flow_search_mode == R307_SEARCH_HIGH_SPEED || (r307_get_response()->received && (confirmation_code == 0x00 || confirmation_code == 0x09)))
+    {
+        return confirmation_code;
+    }
+
+    *search_instruction = 0x04;                                                         //++ Unknown command on this firmware, or no answer
+    confirmation_code = Search(r307_address, buffer_id, start_page, page_number);
+    if(r307_get_response()->received)
+    {
+        ESP_LOGW(R307_FLOW, "HighSpeedSearch not supported, using Search from now on");
+        flow_high_speed_rejected = 1;
+    }
+
+    return confirmation_code;
+}
+
+uint8_t r307_identify(char r307_address[], uint16_t library_size, r307_identify_result_t *result)
+{
+    char buffer_id[1] = {0x01};                                                         //++ Character file goes to CharBuffer1
+    char start_page[2] = {0x00, 0x00};
+    char page_number[2] = {(library_size >> 8) & 0xFF, library_size & 0xFF};
+    const int64_t start_time = esp_timer_get_time();
+    uint8_t confirmation_code = 0;
+    uint8_t repeat_usable = 0;
+    r307_char_buffer_t buffer_state;
+
+    memset(result, 0, sizeof(*result));
+    r307_link_acquire();                                                                //++ The whole flow uses ImageBuffer & the CharBuffers, keep other tasks out
+
+    repeat_usable = r307_flow_repeat_usable(start_time);
+    if(repeat_usable)
+    {
+        buffer_id[0] = (flow_repeat.buffer_id == 0x01) ? 0x02 : 0x01;                   //++ Keep the previous finger, capture into the other buffer
+    }
+
+    confirmation_code = GenImg(r307_address);                                           //++ Capture the finger into ImageBuffer
+    if(confirmation_code != 0x00)
+    {
+        result->failed_instruction = 0x01;
+    }
+
+    if(confirmation_code == 0x00)
+    {
+        confirmation_code = Img2Tz(r307_address, buffer_id);                            //++ Generate character file into the selected CharBuffer
+        if(confirmation_code != 0x00)
+        {
+            result->failed_instruction = 0x02;
+        }
+    }
+
+    if(confirmation_code == 0x00 && repeat_usable && Match(r307_address) == 0x00 && r307_get_response()->match_score >= flow_repeat_min_score)
+    {
+        result->repeat = 1;                                                             //++ Same finger again, no need to search the library
+        result->search_instruction = 0x03;
+        result->page_id = flow_repeat.page_id;
+        result->match_score = flow_repeat.match_score;
+    }
+    else if(confirmation_code == 0x00)
+    {
+        confirmation_code = r307_flow_search(r307_address, buffer_id, start_page, page_number, &result->search_instruction);   //++ Search the library for the character file
+        if(confirmation_code != 0x00)
+        {
+            result->failed_instruction = result->search_instruction;
+        }
+        else
+        {
+            result->page_id = r307_get_response()->page_id;
+            result->match_score = r307_get_response()->match_score;
+        }
+
+        r307_get_char_buffer(buffer_id[0], &buffer_state);
+        flow_repeat.valid = (confirmation_code == 0x00 && flow_repeat_window_ms);      //++ Only found fingers are reused, a retry of a rejected one is searched again
+        flow_repeat.buffer_id = buffer_id[0];
+        flow_repeat.image_generation = buffer_state.image_generation;
+        flow_repeat.library_generation = r307_get_library_generation();
+        flow_repeat.page_id = result->page_id;
+        flow_repeat.match_score = result->match_score;
+        flow_repeat.found_us = start_time;
+    }
+    r307_link_release();
+
+    result->confirmation_code = confirmation_code;
+    result->latency_us = esp_timer_get_time() - start_time;
+    ESP_LOGI(R307_FLOW, "Identify finished with code 0x%02X in %lld us", confirmation_code, (long long)result->latency_us);
+
+    return confirmation_code;
+}
+
+uint8_t r307_flow_search_bench(char r307_address[], uint16_t library_size, uint16_t rounds, r307_search_bench_t *bench)
+{
+    char buffer_id[1] = {0x01};
+    char start_page[2] = {0x00, 0x00};
+    char page_number[2] = {(library_size >> 8) & 0xFF, library_size & 0xFF};
+    int64_t search_us = 0;
+    int64_t high_speed_us = 0;
+    uint8_t confirmation_code = 0;
+
+    memset(bench, 0, sizeof(*bench));
+    r307_link_acquire();                                                                //++ Every round must search the same CharBuffer1
+
+    confirmation_code = GenImg(r307_address);
+    if(confirmation_code == 0x00)
+    {
+        confirmation_code = Img2Tz(r307_address, buffer_id);
+    }
+
+    for(int i=0; confirmation_code == 0x00 && i<rounds; i++)
+    {
+        uint16_t search_page = 0;
+        int64_t start_time = esp_timer_get_time();
+
+        bench->search_code = Search(r307_address, buffer_id, start_page, page_number);
+        search_us += esp_timer_get_time() - start_time;
+        search_page = r307_get_response()->page_id;
+
+        start_time = esp_timer_get_time();
+        bench->high_speed_code = HighSpeedSearch(r307_address, buffer_id, start_page, page_number);
+        high_speed_us += esp_timer_get_time() - start_time;
+
+        bench->rounds++;
+        bench->agreements += (bench->search_code == bench->high_speed_code && (bench->search_code != 0x00 || search_page == r307_get_response()->page_id));
+    }
+    r307_link_release();
+
+    if(bench->rounds)
+    {
+        bench->search_us = search_us / bench->rounds;
+        bench->high_speed_us = high_speed_us / bench->rounds;
+        ESP_LOGI(R307_FLOW, "Search %lld us, HighSpeedSearch %lld us, %d of %d rounds agree", (long long)bench->search_us, (long long)bench->high_speed_us, bench->agreements, bench->rounds);
+    }
+
+    return confirmation_code;
+}
+
+uint8_t r307_verify_pages(char r307_address[], const uint16_t page_ids[], int count, r307_verify_result_t *result)
+{
+    char buffer_1[1] = {0x01};                                                          //++ Live finger goes to CharBuffer1
+    char buffer_2[1] = {0x02};                                                          //++ Claimed template goes to CharBuffer2
+    const int64_t start_time = esp_timer_get_time();
+    r307_char_buffer_t resident;
+    int first = 0;
+    uint8_t confirmation_code = 0;
+
+    memset(result, 0, sizeof(*result));
+    if(page_ids == NULL || count <= 0)                                                  //++ No claimed template, nothing can match
+    {
+        result->confirmation_code = 0x08;
+        return 0x08;
+    }
+    r307_link_acquire();                                                                //++ The whole flow uses ImageBuffer & both CharBuffers, keep other tasks out
+
+    r307_get_char_buffer(0x02, &resident);
+    for(int i=0; i<count; i++)                                                          //++ Compare the page still in CharBuffer2 first
+    {
+        if(resident.source == R307_CHAR_PAGE && resident.page_id == page_ids[i])
+        {
+            first = i;
+        }
+    }
+
+    confirmation_code = GenImg(r307_address);                                           //++ Capture the finger into ImageBuffer
+    if(confirmation_code != 0x00)
+    {
+        result->failed_instruction = 0x01;
+    }
+
+    if(confirmation_code == 0x00)
+    {
+        confirmation_code = Img2Tz(r307_address, buffer_1);                             //++ Generate character file into CharBuffer1
+        if(confirmation_code != 0x00)
+        {
+            result->failed_instruction = 0x02;
+        }
+    }
+
+    for(int n=0; confirmation_code == 0x00 && n<count; n++)
+    {
+        const uint16_t page_id = page_ids[(first + n) % count];
+        char page[2] = {page_id >> 8, page_id & 0xFF};
+
+        result->page_id = page_id;
+        r307_get_char_buffer(0x02, &resident);
+        result->loads_skipped += (resident.source == R307_CHAR_PAGE && resident.page_id == page_id);
+        confirmation_code = r307_load_char_cached(r307_address, buffer_2, page);        //++ Read the claimed template into CharBuffer2, unless it is still there
+        if(confirmation_code == 0x0C && n + 1 < count)                                  //++ Empty page, try the user's next template
+        {
+            confirmation_code = 0x00;
+            continue;
+        }
+        if(confirmation_code != 0x00)
+        {
+            result->failed_instruction = 0x07;
+            break;
+        }
+
+        confirmation_code = Match(r307_address);                                        //++ Compare CharBuffer1 with CharBuffer2
+        if(!r307_get_response()->received)
+        {
+            confirmation_code = 0x01;                                                   //++ An unanswered Match must never read as a match
+        }
+        result->pages_compared++;
+        result->match_score = r307_get_response()->match_score;
+        if(confirmation_code == 0x00)
+        {
+            break;
+        }
+        if(confirmation_code != 0x08)
+        {
+            result->failed_instruction = 0x03;
+            break;
+        }
+        if(n + 1 < count)                                                               //++ No match, try the user's next template
+        {
+            confirmation_code = 0x00;
+        }
+    }
+    r307_link_release();
+
+    if(confirmation_code == 0x00 && result->pages_compared == 0)                        //++ Only an answered Match may report a match
+    {
+        confirmation_code = 0x08;
+    }
+    result->confirmation_code = confirmation_code;
+    result->latency_us = esp_timer_get_time() - start_time;
+    ESP_LOGI(R307_FLOW, "Verify finished with code 0x%02X, score %d in %lld us", confirmation_code, result->match_score, (long long)result->latency_us);
+
+    return confirmation_code;
+}
+
+uint8_t r307_verify(char r307_address[], uint16_t page_id, r307_verify_result_t *result)
+{
+    return r307_verify_pages(r307_address, &page_id, 1, result);
+}
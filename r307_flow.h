@@ -0,0 +1,132 @@
+#include <stdint.h>
+
+#ifndef r307_flow_H
+#define r307_flow_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief LIBRARY SEARCH USED BY THE IDENTIFY FLOW
+ */
+typedef enum
+{
+    R307_SEARCH_NORMAL = 0,                 //++ Search ( every firmware )
+    R307_SEARCH_HIGH_SPEED,                 //++ HighSpeedSearch only
+    R307_SEARCH_AUTO,                       //++ HighSpeedSearch, falling back to Search for good if the module rejects it
+} r307_search_mode_t;
+
+/**
+ * @brief RESULT OF ONE IDENTIFY FLOW ( GenImg -> Img2Tz -> Search )
+ */
+typedef struct
+{
+    uint8_t confirmation_code;              //++ Confirmation Code of the last executed step ( 0x00 : Finger Found )
+    uint8_t failed_instruction;             //++ Instruction Code of the step that failed ( 0x00 when all steps passed )
+    uint8_t search_instruction;             //++ 0x04 : Search | 0x1B : HighSpeedSearch | 0x03 : Match against the previous finger answered the flow
+    uint8_t repeat;                         //++ 1 : Same finger as the previous identify within the repeat window, page & score are the cached ones
+    uint16_t page_id;                       //++ Page ID of the matching template
+    uint16_t match_score;                   //++ Match Score of the matching template
+    int64_t latency_us;                     //++ Time taken by the whole flow in microseconds
+} r307_identify_result_t;
+
+/**
+ * @brief LATENCY OF Search AGAINST HighSpeedSearch ON THE SAME CHARACTER FILE & LIBRARY
+ */
+typedef struct
+{
+    uint16_t rounds;                        //++ Searches run with each command
+    uint16_t agreements;                    //++ Rounds where both commands returned the same code & page
+    uint8_t search_code;                    //++ Confirmation Code of the last Search
+    uint8_t high_speed_code;                //++ Confirmation Code of the last HighSpeedSearch
+    int64_t search_us;                      //++ Average Search latency in microseconds
+    int64_t high_speed_us;                  //++ Average HighSpeedSearch latency in microseconds
+} r307_search_bench_t;
+
+/**
+ * @brief FUNCTION TO SELECT THE LIBRARY SEARCH OF r307_identify
+ *
+ * @param mode R307_SEARCH_NORMAL ( DEFAULT ) | R307_SEARCH_HIGH_SPEED | R307_SEARCH_AUTO
+ * @return
+ */
+void r307_flow_set_search_mode(r307_search_mode_t mode);
+
+/**
+ * @brief FUNCTION TO ANSWER REPEAT TOUCHES FROM THE PREVIOUS RESULT : WITHIN window_ms OF A FOUND FINGER, r307_identify FIRST MATCHES
+ *        THE NEW CAPTURE AGAINST THE PREVIOUS ONE ( STILL IN ITS CHARBUFFER ) AND SKIPS Search IF THEY MATCH
+ *
+ * @param window_ms HOW LONG A FOUND RESULT IS REUSED ( 0 : DISABLED, DEFAULT )
+ * @param min_score LOWEST Match SCORE COUNTED AS THE SAME FINGER
+ * @return
+ */
+void r307_flow_set_repeat_window(uint32_t window_ms, uint16_t min_score);
+
+/**
+ * @brief FUNCTION TO FORGET THE CACHED RESULT ( LIBRARY CHANGES THROUGH THE DRIVER ALREADY DROP IT )
+ *
+ * @return
+ */
+void r307_flow_clear_repeat(void);
+
+/**
+ * @brief FUNCTION TO CAPTURE A FINGER AND SEARCH IT IN THE LIBRARY ( 1:N IDENTIFY )
+ *
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @param library_size NUMBER OF PAGES TO SEARCH STARTING FROM PAGE 0
+ * @param result FILLED WITH CONFIRMATION CODE, PAGE ID, MATCH SCORE & LATENCY
+ * @return RETURNS CONFIRMATION CODE OF THE LAST EXECUTED STEP
+ */
+uint8_t r307_identify(char r307_address[], uint16_t library_size, r307_identify_result_t *result);
+
+/**
+ * @brief FUNCTION TO CAPTURE A FINGER ONCE, THEN TIME Search & HighSpeedSearch OVER THE SAME LIBRARY
+ *
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @param library_size NUMBER OF PAGES TO SEARCH STARTING FROM PAGE 0
+ * @param rounds SEARCHES TO RUN WITH EACH COMMAND
+ * @param bench FILLED WITH AVERAGE LATENCIES & AGREEMENT OF BOTH COMMANDS
+ * @return RETURNS 0x00, ELSE CONFIRMATION CODE OF THE FAILED GenImg / Img2Tz
+ */
+uint8_t r307_flow_search_bench(char r307_address[], uint16_t library_size, uint16_t rounds, r307_search_bench_t *bench);
+
+/**
+ * @brief RESULT OF ONE VERIFY FLOW ( GenImg -> Img2Tz -> LoadChar -> Match )
+ */
+typedef struct
+{
+    uint8_t confirmation_code;              //++ Confirmation Code of the last executed step ( 0x00 : Finger Matches )
+    uint8_t failed_instruction;             //++ Instruction Code of the step that failed ( 0x00 when all steps passed )
+    uint16_t page_id;                       //++ Page ID of the matching template ( last compared page if none matched )
+    uint16_t match_score;                   //++ Match Score against that page
+    uint8_t pages_compared;                 //++ Templates compared before the flow stopped
+    uint8_t loads_skipped;                  //++ LoadChar skipped because the page was still in CharBuffer2
+    int64_t latency_us;                     //++ Time taken by the whole flow in microseconds
+} r307_verify_result_t;
+
+/**
+ * @brief FUNCTION TO CAPTURE A FINGER AND MATCH IT AGAINST ONE CLAIMED PAGE ( 1:1 VERIFY )
+ *
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @param page_id PAGE OF THE CLAIMED USER'S TEMPLATE
+ * @param result FILLED WITH CONFIRMATION CODE, MATCH SCORE & LATENCY
+ * @return RETURNS CONFIRMATION CODE OF THE LAST EXECUTED STEP ( 0x08 : FINGER DOES NOT MATCH )
+ */
+uint8_t r307_verify(char r307_address[], uint16_t page_id, r307_verify_result_t *result);
+
+/**
+ * @brief FUNCTION TO CAPTURE A FINGER ONCE AND MATCH IT AGAINST SEVERAL PAGES, STOPPING AT THE FIRST MATCH
+ *
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @param page_ids PAGES OF THE CLAIMED USER'S TEMPLATES
+ * @param count NUMBER OF PAGES
+ * @param result FILLED WITH CONFIRMATION CODE, MATCHING PAGE, MATCH SCORE & LATENCY
+ * @return RETURNS CONFIRMATION CODE OF THE LAST EXECUTED STEP ( 0x08 : NO PAGE MATCHES OR NO PAGES GIVEN )
+ */
+uint8_t r307_verify_pages(char r307_address[], const uint16_t page_ids[], int count, r307_verify_result_t *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // r307_flow_H
@@ -0,0 +1,239 @@
+#include <stdint.h>
+#include "string.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include "r307.h"
+#include "r307_power.h"
+#include "r307_sched.h"
+#include "r307_health.h"
+
+#define R307_HEALTH_PERIOD_MS (5000)            //++ Default check period
+#define R307_HEALTH_THRESHOLD (3)               //++ Default failed probes before recovery
+#define R307_HEALTH_POWER_OFF_MS (200)          //++ Default unpowered time of a power cycle
+#define R307_HEALTH_STACK_SIZE (4096)           //++ Default stack size of the monitor task
+#define R307_HEALTH_PRIORITY (3)                //++ Default priority of the monitor task
+
+static const char *R307_HEALTH = "R307_HEALTH"; //++ Health TAG
+
+static r307_health_config_t health_config;      //++ Active monitor configuration
+static r307_health_stats_t health_stats;
+static TaskHandle_t health_task_handle;         //++ Monitor task
+static SemaphoreHandle_t health_exited;         //++ Given by the monitor task right before it deletes itself
+static volatile uint8_t health_running;         //++ 1 while the monitor task should keep running
+static uint8_t health_failed_probes;            //++ Failed probes in a row
+static int64_t health_up_since_us;              //++ End of the last outage ( or monitor start )
+static int64_t health_first_failure_us;         //++ First failed probe of the current streak
+
+static void r307_health_set_state(r307_health_state_t state)
+{
+    if(health_stats.state == state)
+    {
+        return;
+    }
+
+    ESP_LOGI(R307_HEALTH, "Module health %d -> %d", health_stats.state, state);
+    health_stats.state = state;
+    if(health_config.callback != NULL)
+    {
+        health_config.callback(state, health_config.callback_arg);
+    }
+}
+
+static uint8_t r307_health_recover(void)
+{
+    uint8_t confirmation_code = 0;
+    uint8_t answered = 0;
+
+    health_stats.recovery_attempts++;
+    r307_link_acquire();                                                                //++ No other task may talk to the module while it is re-initialized
+    if(health_config.power_cycle)
+    {
+        r307_power_down();
+        vTaskDelay(pdMS_TO_TICKS(health_config.power_off_ms));
+        confirmation_code = r307_power_resume();                                        //++ Re-installs the UART & handshakes
+    }
+    else
+    {
+        r307_deinit();
+        r307_init();
+        confirmation_code = VfyPwd(health_config.r307_address, health_config.r307_password);
+    }
+    answered = r307_get_response()->received;                                           //++ Any answer, even a rejected password, means the module is back
+
+    if(answered && ReadSysPara(health_config.r307_address) == 0x00 && r307_get_response()->received)
+    {
+        r307_set_packet_size(32 << r307_get_response()->size_code);                     //++ Module keeps its packet size, the fresh driver does not
+    }
+    r307_link_release();
+
+    ESP_LOGW(R307_HEALTH, "Recovery %s, handshake code 0x%02X", answered ? "done" : "failed", confirmation_code);
+
+    return answered;
+}
+
+static void r307_health_answered(void)
+{
+    const int64_t now = esp_timer_get_time();
+
+    if(health_stats.state == R307_HEALTH_DOWN)
+    {
+        health_stats.recoveries++;
+        health_stats.last_down_us = now - health_first_failure_us;
+        health_stats.total_down_us += health_stats.last_down_us;
+        health_stats.max_down_us = (health_stats.last_down_us > health_stats.max_down_us) ? health_stats.last_down_us : health_stats.max_down_us;
+        health_up_since_us = now;
+    }
+    health_failed_probes = 0;
+    r307_health_set_state(R307_HEALTH_OK);
+}
+
+static void r307_health_failed(void)
+{
+    health_stats.probe_failures++;
+    if(health_failed_probes++ == 0)
+    {
+        health_first_failure_us = esp_timer_get_time();
+    }
+    if(health_failed_probes < health_config.failure_threshold)
+    {
+        r307_health_set_state(R307_HEALTH_SUSPECT);
+        return;
+    }
+
+    if(health_stats.state != R307_HEALTH_DOWN)                                          //++ Up time ends at the first failed probe of the streak
+    {
+        health_stats.outages++;
+        health_stats.total_up_us += health_first_failure_us - health_up_since_us;
+        r307_health_set_state(R307_HEALTH_DOWN);
+    }
+    if(r307_health_recover())
+    {
+        r307_health_answered();
+    }
+}
+
+static void r307_health_task(void *arg)
+{
+    r307_link_stats_t link_stats;
+    uint32_t last_commands = 0;
+    uint32_t last_timeouts = 0;
+
+    r307_sched_set_task_class(NULL, R307_SCHED_BACKGROUND);                             //++ Probes never delay a live identify ( ignored without the scheduler )
+    r307_get_link_stats(&link_stats);
+    last_commands = link_stats.commands;
+    last_timeouts = link_stats.timeouts;
+
+    while(health_running)
+    {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(health_config.probe_period_ms));          //++ Notified by r307_health_stop
+        if(!health_running)
+        {
+            break;
+        }
+
+        r307_get_link_stats(&link_stats);
+        if(link_stats.commands != last_commands && link_stats.timeouts == last_timeouts && health_stats.state == R307_HEALTH_OK)
+        {
+            health_stats.passive_checks++;                                              //++ Application traffic was answered, no need to probe
+        }
+        else
+        {
+            uint8_t confirmation_code = 0;
+            uint8_t answered = 0;
+
+            health_stats.probes++;
+            r307_link_acquire();                                                        //++ Response must not be replaced by another task's before it is read
+            confirmation_code = VfyPwd(health_config.r307_address, health_config.r307_password);
+            answered = r307_get_response()->received;
+            r307_link_release();
+
+            if(answered)                                                                //++ Liveness only, a rejected password ( 0x13 ) is still a working sensor
+            {
+                health_stats.rejected_probes = health_stats.rejected_probes + (confirmation_code != 0x00);
+                r307_health_answered();
+            }
+            else
+            {
+                r307_health_failed();
+            }
+        }
+
+        r307_get_link_stats(&link_stats);
+        last_commands = link_stats.commands;
+        last_timeouts = link_stats.timeouts;
+    }
+
+    xSemaphoreGive(health_exited);
+    vTaskDelete(NULL);
+}
+
+esp_err_t r307_health_start(const r307_health_config_t *config)
+{
+    if(config == NULL || health_task_handle != NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if(health_exited == NULL)
+    {
+        health_exited = xSemaphoreCreateBinary();
+        if(health_exited == NULL)
+        {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    memcpy(&health_config, config, sizeof(health_config));
+    health_config.probe_period_ms = health_config.probe_period_ms ? health_config.probe_period_ms : R307_HEALTH_PERIOD_MS;
+    health_config.failure_threshold = health_config.failure_threshold ? health_config.failure_threshold : R307_HEALTH_THRESHOLD;
+    health_config.power_off_ms = health_config.power_off_ms ? health_config.power_off_ms : R307_HEALTH_POWER_OFF_MS;
+    memset(&health_stats, 0, sizeof(health_stats));
+    health_failed_probes = 0;
+    health_up_since_us = esp_timer_get_time();
+
+    health_running = 1;
+    if(xTaskCreate(r307_health_task, "r307_health",
+                   health_config.task_stack_size ? health_config.task_stack_size : R307_HEALTH_STACK_SIZE,
+                   NULL,
+                   health_config.task_priority ? health_config.task_priority : R307_HEALTH_PRIORITY,
+                   &health_task_handle) != pdPASS)
+    {
+        health_running = 0;
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(R307_HEALTH, "Health monitor started, checking every %lu ms", (unsigned long)health_config.probe_period_ms);
+    return ESP_OK;
+}
+
+esp_err_t r307_health_stop(void)
+{
+    if(health_task_handle == NULL || health_task_handle == xTaskGetCurrentTaskHandle())    //++ Not from the callback, the task can't wait for itself
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    health_running = 0;
+    xTaskNotifyGive(health_task_handle);                                                //++ Cut the probe period short
+    xSemaphoreTake(health_exited, portMAX_DELAY);                                       //++ Waits for a probe or recovery in progress
+    health_task_handle = NULL;
+
+    return ESP_OK;
+}
+
+void r307_health_get_stats(r307_health_stats_t *stats)
+{
+    memcpy(stats, &health_stats, sizeof(*stats));
+    if(stats->state != R307_HEALTH_DOWN)
+    {
+        stats->total_up_us += esp_timer_get_time() - health_up_since_us;               //++ Current up period counts too
+    }
+    stats->mtbf_us = stats->outages ? stats->total_up_us / stats->outages : 0;
+    stats->mttr_us = stats->recoveries ? stats->total_down_us / stats->recoveries : 0;
+}
@@ -0,0 +1,95 @@
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#ifndef r307_health_H
+#define r307_health_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief HEALTH OF THE MODULE AS SEEN BY THE MONITOR
+ */
+typedef enum
+{
+    R307_HEALTH_OK = 0,                     //++ Last command or probe was answered
+    R307_HEALTH_SUSPECT,                    //++ Probes failed, fewer than failure_threshold in a row
+    R307_HEALTH_DOWN,                       //++ Outage, the module is re-initialized every probe period until it answers
+} r307_health_state_t;
+
+/**
+ * @brief CALLBACK CALLED FROM THE MONITOR TASK WHEN THE HEALTH STATE CHANGES
+ *
+ * @param state NEW STATE
+ * @param arg USER ARGUMENT GIVEN IN THE CONFIGURATION
+ */
+typedef void (*r307_health_cb_t)(r307_health_state_t state, void *arg);
+
+/**
+ * @brief CONFIGURATION OF THE HEALTH MONITOR
+ */
+typedef struct
+{
+    char r307_address[4];                   //++ Module Address used by the probes
+    char r307_password[4];                  //++ Module Password used by the probes
+    uint32_t probe_period_ms;               //++ Check period, a probe is only sent if the link was idle ( 0 : Default )
+    uint8_t failure_threshold;              //++ Failed probes in a row before the module is re-initialized ( 0 : Default )
+    uint8_t power_cycle;                    //++ 1 : Recover through r307_power_down / r307_power_resume ( r307_power_init must be called ) | 0 : UART only
+    uint32_t power_off_ms;                  //++ Time the sensor is kept unpowered during a power cycle ( 0 : Default )
+    r307_health_cb_t callback;              //++ Called on every state change ( NULL : None )
+    void *callback_arg;                     //++ User argument passed to the callback
+    uint32_t task_stack_size;               //++ Stack size of the monitor task ( 0 : Default )
+    unsigned int task_priority;             //++ Priority of the monitor task ( 0 : Default )
+} r307_health_config_t;
+
+/**
+ * @brief AVAILABILITY STATISTICS OF THE MODULE
+ */
+typedef struct
+{
+    r307_health_state_t state;              //++ Current state
+    uint32_t probes;                        //++ Probes ( VfyPwd ) sent on an idle link, only whether they are answered counts
+    uint32_t probe_failures;                //++ Probes left unanswered or broken
+    uint32_t rejected_probes;               //++ Probes answered with an error ( e.g. 0x13 after a password change ), the sensor counts as alive
+    uint32_t passive_checks;                //++ Checks answered by application traffic, no probe sent
+    uint32_t outages;                       //++ Times failure_threshold was reached
+    uint32_t recovery_attempts;             //++ Re-initializations ( power cycles ) tried
+    uint32_t recoveries;                    //++ Outages ended by an answered handshake
+    int64_t total_up_us;                    //++ Time spent outside outages
+    int64_t total_down_us;                  //++ Time spent in outages that ended, from the first failed probe
+    int64_t last_down_us;                   //++ Length of the last outage
+    int64_t max_down_us;                    //++ Longest outage
+    int64_t mtbf_us;                        //++ Mean time between failures ( total_up_us / outages, 0 without outages )
+    int64_t mttr_us;                        //++ Mean time to recover ( total_down_us / recoveries, 0 without recoveries )
+} r307_health_stats_t;
+
+/**
+ * @brief FUNCTION TO START THE MONITOR TASK
+ *
+ * @param config PROBE CREDENTIALS, PERIOD, RECOVERY & TASK SETTINGS
+ * @return RETURNS ESP_OK, ESP_ERR_INVALID_STATE IF ALREADY RUNNING, ESP_ERR_NO_MEM IF THE TASK COULD NOT BE CREATED
+ */
+esp_err_t r307_health_start(const r307_health_config_t *config);
+
+/**
+ * @brief FUNCTION TO STOP THE MONITOR TASK, WAITS FOR ITS CURRENT CHECK OR RECOVERY TO FINISH
+ *
+ * @return RETURNS ESP_OK ONCE THE TASK HAS EXITED, ESP_ERR_INVALID_STATE IF NOT RUNNING OR CALLED FROM THE CALLBACK
+ */
+esp_err_t r307_health_stop(void);
+
+/**
+ * @brief FUNCTION TO GET THE CURRENT STATE & AVAILABILITY STATISTICS
+ *
+ * @param stats FILLED WITH THE STATISTICS ( UP TIME INCLUDES THE CURRENT UP PERIOD )
+ * @return
+ */
+void r307_health_get_stats(r307_health_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // r307_health_H
@@ -0,0 +1,230 @@
+#include <stdint.h>
+#include <math.h>
+#include "string.h"
+
+#include "esp_log.h"
+
+#include "r307.h"
+#include "r307_image.h"
+
+#define R307_IMAGE_MIN_CONTRAST (6)             //++ Default minimum contrast
+#define R307_IMAGE_MIN_RIDGE_CLARITY (350)      //++ Default minimum ridge clarity ( permille )
+#define R307_IMAGE_MIN_COVERAGE (400)           //++ Default minimum coverage ( permille )
+#define R307_IMAGE_FOREGROUND_VARIANCE (24)     //++ Default foreground variance ( x16, i.e. 1.5 gray levels squared )
+
+static const char *R307_IMAGE = "R307_IMAGE";   //++ Image TAG
+
+static void r307_image_unpack(const uint8_t *restrict packed, uint8_t *restrict line)
+{
+    for(int i=0; i<R307_IMAGE_ROW_BYTES; i++)                                           //++ High nibble is the left pixel
+    {
+        line[2 * i] = packed[i] >> 4;
+        line[2 * i + 1] = packed[i] & 0x0F;
+    }
+}
+
+static void r307_image_gradients(const uint8_t *restrict line, const uint8_t *restrict previous, int16_t *restrict gradient_x, int16_t *restrict gradient_y)
+{
+    for(int x=1; x<R307_IMAGE_WIDTH - 1; x++)                                           //++ Central difference, border columns stay 0
+    {
+        gradient_x[x] = (int16_t)line[x + 1] - (int16_t)line[x - 1];
+    }
+    for(int x=0; x<R307_IMAGE_WIDTH; x++)                                               //++ Backward difference against the previous row
+    {
+        gradient_y[x] = (int16_t)line[x] - (int16_t)previous[x];
+    }
+}
+
+static void r307_image_accumulate(r307_image_pipeline_t *pipeline, const uint8_t *restrict line)
+{
+    const int16_t *restrict gradient_x = pipeline->gradient_x;
+    const int16_t *restrict gradient_y = pipeline->gradient_y;
+
+    for(int block=0; block<R307_IMAGE_BLOCKS_X; block++)
+    {
+        int32_t gxx = 0;
+        int32_t gyy = 0;
+        int32_t gxy = 0;
+        int32_t sum = 0;
+        int32_t sum_sq = 0;
+        const int offset = block * R307_IMAGE_BLOCK;
+
+        for(int x=0; x<R307_IMAGE_BLOCK; x++)                                           //++ Fixed trip count, no branches : vectorizable
+        {
+            const int32_t gx = gradient_x[offset + x];
+            const int32_t gy = gradient_y[offset + x];
+            const int32_t pixel = line[offset + x];
+            gxx += gx * gx;
+            gyy += gy * gy;
+            gxy += gx * gy;
+            sum += pixel;
+            sum_sq += pixel * pixel;
+        }
+
+        pipeline->block_gxx[block] += gxx;
+        pipeline->block_gyy[block] += gyy;
+        pipeline->block_gxy[block] += gxy;
+        pipeline->block_sum[block] += sum;
+        pipeline->block_sum_sq[block] += sum_sq;
+    }
+
+    for(int x=0; x<R307_IMAGE_WIDTH; x++)
+    {
+        pipeline->histogram[line[x]]++;
+    }
+}
+
+static void r307_image_close_band(r307_image_pipeline_t *pipeline)
+{
+    const int32_t pixels = R307_IMAGE_BLOCK * R307_IMAGE_BLOCK;
+
+    for(int block=0; block<R307_IMAGE_BLOCKS_X; block++)
+    {
+        const int32_t sum = pipeline->block_sum[block];
+        const int32_t variance_x16 = (16 * (pixels * pipeline->block_sum_sq[block] - sum * sum)) / (pixels * pixels);
+
+        pipeline->total_blocks++;
+        if(variance_x16 >= pipeline->foreground_variance)                               //++ Background ( no finger ) is flat
+        {
+            const float gxx = pipeline->block_gxx[block];
+            const float gyy = pipeline->block_gyy[block];
+            const float gxy = pipeline->block_gxy[block];
+            const float energy = gxx + gyy;
+
+            pipeline->foreground_blocks++;
+            if(energy > 0)                                                              //++ Coherence is 1 for clean parallel ridges, 0 for noise
+            {
+                pipeline->coherence_sum += (uint32_t)(1000.0f * sqrtf((gxx - gyy) * (gxx - gyy) + 4.0f * gxy * gxy) / energy);
+            }
+        }
+    }
+
+    memset(pipeline->block_gxx, 0, sizeof(pipeline->block_gxx));
+    memset(pipeline->block_gyy, 0, sizeof(pipeline->block_gyy));
+    memset(pipeline->block_gxy, 0, sizeof(pipeline->block_gxy));
+    memset(pipeline->block_sum, 0, sizeof(pipeline->block_sum));
+    memset(pipeline->block_sum_sq, 0, sizeof(pipeline->block_sum_sq));
+}
+
+static void r307_image_process_row(r307_image_pipeline_t *pipeline)
+{
+    uint8_t *line = pipeline->line[pipeline->row & 1];
+    const uint8_t *previous = pipeline->row ? pipeline->line[(pipeline->row + 1) & 1] : line;  //++ First row has no vertical gradient
+
+    r307_image_unpack(pipeline->packed_row, line);
+    r307_image_gradients(line, previous, pipeline->gradient_x, pipeline->gradient_y);
+    r307_image_accumulate(pipeline, line);
+
+    pipeline->row++;
+    if(pipeline->row % R307_IMAGE_BLOCK == 0)
+    {
+        r307_image_close_band(pipeline);
+    }
+}
+
+void r307_image_begin(r307_image_pipeline_t *pipeline, const r307_image_thresholds_t *thresholds)
+{
+    memset(pipeline, 0, sizeof(*pipeline));
+    pipeline->foreground_variance = (thresholds != NULL && thresholds->foreground_variance) ? thresholds->foreground_variance : R307_IMAGE_FOREGROUND_VARIANCE;
+}
+
+int r307_image_feed(const uint8_t data[], int length, void *arg)
+{
+    r307_image_pipeline_t *pipeline = (r307_image_pipeline_t *)arg;
+
+    while(length > 0)                                                                   //++ Data Packages need not be aligned to rows
+    {
+        if(pipeline->row >= R307_IMAGE_HEIGHT)
+        {
+            return 1;
+        }
+
+        int chunk = R307_IMAGE_ROW_BYTES - pipeline->row_fill;
+        chunk = chunk < length ? chunk : length;
+        memcpy(&pipeline->packed_row[pipeline->row_fill], data, chunk);
+        pipeline->row_fill += chunk;
+        data += chunk;
+        length -= chunk;
+
+        if(pipeline->row_fill == R307_IMAGE_ROW_BYTES)
+        {
+            r307_image_process_row(pipeline);
+            pipeline->row_fill = 0;
+        }
+    }
+
+    return 0;
+}
+
+void r307_image_finish(r307_image_pipeline_t *pipeline, r307_image_metrics_t *metrics)
+{
+    uint32_t pixels = 0;
+    uint32_t weighted = 0;
+    uint32_t cumulative = 0;
+    int low = -1;
+    int high = -1;
+
+    if(pipeline->row % R307_IMAGE_BLOCK != 0)                                           //++ Close a partial band of a short image
+    {
+        r307_image_close_band(pipeline);
+    }
+
+    for(int level=0; level<16; level++)
+    {
+        pixels += pipeline->histogram[level];
+        weighted += pipeline->histogram[level] * level;
+    }
+    for(int level=0; level<16 && pixels > 0; level++)
+    {
+        cumulative += pipeline->histogram[level];
+        if(low < 0 && cumulative * 20 >= pixels)                                        //++ 5th percentile
+        {
+            low = level;
+        }
+        if(high < 0 && cumulative * 20 >= pixels * 19)                                  //++ 95th percentile
+        {
+            high = level;
+        }
+    }
+
+    memset(metrics, 0, sizeof(*metrics));
+    metrics->rows = pipeline->row;
+    if(pixels > 0)
+    {
+        metrics->contrast = high - low;
+        metrics->mean = weighted / pixels;
+    }
+    if(pipeline->foreground_blocks > 0)
+    {
+        metrics->ridge_clarity = pipeline->coherence_sum / pipeline->foreground_blocks;
+    }
+    if(pipeline->total_blocks > 0)
+    {
+        metrics->coverage = (1000 * pipeline->foreground_blocks) / pipeline->total_blocks;
+    }
+
+    ESP_LOGI(R307_IMAGE, "Contrast %d, Ridge Clarity %d, Coverage %d, Rows %d", metrics->contrast, metrics->ridge_clarity, metrics->coverage, metrics->rows);
+}
+
+uint8_t r307_image_check(const r307_image_metrics_t *metrics, const r307_image_thresholds_t *thresholds)
+{
+    const uint8_t min_contrast = thresholds ? thresholds->min_contrast : R307_IMAGE_MIN_CONTRAST;
+    const uint16_t min_ridge_clarity = thresholds ? thresholds->min_ridge_clarity : R307_IMAGE_MIN_RIDGE_CLARITY;
+    const uint16_t min_coverage = thresholds ? thresholds->min_coverage : R307_IMAGE_MIN_COVERAGE;
+
+    return metrics->rows == R307_IMAGE_HEIGHT
+        && metrics->contrast >= min_contrast
+        && metrics->ridge_clarity >= min_ridge_clarity
+        && metrics->coverage >= min_coverage;
+}
+
+uint8_t r307_image_capture(char r307_address[], r307_image_pipeline_t *pipeline, const r307_image_thresholds_t *thresholds, r307_image_metrics_t *metrics)
+{
+    uint8_t confirmation_code = 0;
+
+    r307_image_begin(pipeline, thresholds);
+    confirmation_code = r307_up_image(r307_address, r307_image_feed, pipeline);        //++ Metrics are computed while the packages arrive
+    r307_image_finish(pipeline, metrics);
+
+    return confirmation_code;
+}
@@ -0,0 +1,114 @@
+#include <stdint.h>
+
+#ifndef r307_image_H
+#define r307_image_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define R307_IMAGE_WIDTH (256)                  //++ Pixels per row of an uploaded image
+#define R307_IMAGE_HEIGHT (288)                 //++ Rows of an uploaded image
+#define R307_IMAGE_ROW_BYTES (R307_IMAGE_WIDTH / 2)     //++ 4-bit pixels, 2 per byte, high nibble first
+#define R307_IMAGE_BLOCK (16)                   //++ Block size used for ridge clarity & coverage
+#define R307_IMAGE_BLOCKS_X (R307_IMAGE_WIDTH / R307_IMAGE_BLOCK)
+
+/**
+ * @brief QUALITY METRICS OF ONE UPLOADED IMAGE
+ */
+typedef struct
+{
+    uint8_t contrast;                       //++ 95th minus 5th percentile gray level ( 0 - 15 )
+    uint8_t mean;                           //++ Mean gray level ( 0 - 15 )
+    uint16_t ridge_clarity;                 //++ Mean gradient coherence of foreground blocks in permille
+    uint16_t coverage;                      //++ Foreground blocks in permille of all blocks
+    uint16_t rows;                          //++ Rows processed ( R307_IMAGE_HEIGHT for a complete image )
+} r307_image_metrics_t;
+
+/**
+ * @brief MINIMUM METRICS AN IMAGE NEEDS TO BE WORTH Img2Tz / Search
+ */
+typedef struct
+{
+    uint8_t min_contrast;                   //++ Minimum contrast
+    uint16_t min_ridge_clarity;             //++ Minimum ridge clarity in permille
+    uint16_t min_coverage;                  //++ Minimum coverage in permille
+    uint16_t foreground_variance;           //++ Gray level variance ( x16 ) above which a block is foreground ( 0 : Default )
+} r307_image_thresholds_t;
+
+/**
+ * @brief STREAMING STATE OF THE IMAGE PIPELINE, REUSABLE ACROSS CAPTURES
+ */
+typedef struct
+{
+    uint8_t packed_row[R307_IMAGE_ROW_BYTES];                   //++ Bytes of the row being assembled from Data Packages
+    uint8_t line[2][R307_IMAGE_WIDTH];                          //++ Current & previous unpacked rows
+    int16_t gradient_x[R307_IMAGE_WIDTH];                       //++ Horizontal gradient of the current row
+    int16_t gradient_y[R307_IMAGE_WIDTH];                       //++ Vertical gradient of the current row
+    int32_t block_gxx[R307_IMAGE_BLOCKS_X];                     //++ Per block sums over the current band of 16 rows
+    int32_t block_gyy[R307_IMAGE_BLOCKS_X];
+    int32_t block_gxy[R307_IMAGE_BLOCKS_X];
+    int32_t block_sum[R307_IMAGE_BLOCKS_X];
+    int32_t block_sum_sq[R307_IMAGE_BLOCKS_X];
+    uint32_t histogram[16];                                     //++ Gray level histogram of the whole image
+    uint32_t coherence_sum;                                     //++ Sum of coherence ( permille ) of foreground blocks
+    uint16_t foreground_blocks;
+    uint16_t total_blocks;
+    uint16_t foreground_variance;
+    uint16_t row_fill;                                          //++ Bytes in packed_row
+    uint16_t row;                                               //++ Rows completed
+} r307_image_pipeline_t;
+
+/**
+ * @brief FUNCTION TO RESET THE PIPELINE BEFORE A NEW IMAGE
+ *
+ * @param pipeline PIPELINE TO RESET
+ * @param thresholds THRESHOLDS USED WHILE STREAMING ( NULL : DEFAULTS )
+ * @return
+ */
+void r307_image_begin(r307_image_pipeline_t *pipeline, const r307_image_thresholds_t *thresholds);
+
+/**
+ * @brief FUNCTION TO FEED IMAGE BYTES AS THEY ARRIVE, ROWS ARE PROCESSED AS SOON AS THEY ARE COMPLETE
+ *
+ * @param data PACKED IMAGE BYTES ( CONTENTS OF A DATA PACKAGE )
+ * @param length NUMBER OF BYTES IN data
+ * @param arg PIPELINE ( r307_image_pipeline_t * ), SO IT CAN BE PASSED AS r307_data_cb_t
+ * @return RETURNS 0 TO CONTINUE, 1 IF MORE BYTES THAN AN IMAGE WERE FED
+ */
+int r307_image_feed(const uint8_t data[], int length, void *arg);
+
+/**
+ * @brief FUNCTION TO FINISH THE IMAGE & COMPUTE ITS METRICS
+ *
+ * @param pipeline PIPELINE FED WITH THE IMAGE
+ * @param metrics FILLED WITH CONTRAST, RIDGE CLARITY & COVERAGE
+ * @return
+ */
+void r307_image_finish(r307_image_pipeline_t *pipeline, r307_image_metrics_t *metrics);
+
+/**
+ * @brief FUNCTION TO CHECK METRICS AGAINST THRESHOLDS
+ *
+ * @param metrics METRICS OF THE IMAGE
+ * @param thresholds MINIMUM VALUES ( NULL : DEFAULTS )
+ * @return RETURNS 1 IF THE IMAGE IS GOOD ENOUGH, 0 OTHERWISE
+ */
+uint8_t r307_image_check(const r307_image_metrics_t *metrics, const r307_image_thresholds_t *thresholds);
+
+/**
+ * @brief FUNCTION TO UPLOAD IMG_BUFFER THROUGH THE PIPELINE ( UpImage ) & COMPUTE ITS METRICS
+ *
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @param pipeline PIPELINE TO USE
+ * @param thresholds THRESHOLDS USED WHILE STREAMING ( NULL : DEFAULTS )
+ * @param metrics FILLED WITH CONTRAST, RIDGE CLARITY & COVERAGE
+ * @return RETURNS RECEIVED CONFIRMATION CODE FROM MODULE, OR 0x01 IF THE TRANSFER BROKE
+ */
+uint8_t r307_image_capture(char r307_address[], r307_image_pipeline_t *pipeline, const r307_image_thresholds_t *thresholds, r307_image_metrics_t *metrics);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // r307_image_H
@@ -0,0 +1,468 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include "string.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "r307.h"
+#include "r307_imgcodec.h"
+
+#define R307_IMGCODEC_VERSION (1)               //++ Format version written in the header
+#define R307_IMGCODEC_ZERO_ROW (7)              //++ Row mode : every residual is 0, no payload
+#define R307_IMGCODEC_RAW_ROW (4)               //++ Row mode : 4-bit pixels stored as they are ( noisy rows )
+#define R307_IMGCODEC_MAX_K (3)                 //++ Row modes 0 - 3 : Rice parameter k
+#define R307_IMGCODEC_IN_SIZE (64)              //++ Encoded bytes pulled at once by the decoder
+
+static const char *R307_IMGCODEC = "R307_IMGCODEC";     //++ Codec TAG
+
+/**
+ * Format : 8 byte header, then per row a 3-bit mode followed by the Rice coded
+ * residuals of its 256 pixels. A pixel is predicted from the average of its
+ * left & upper neighbours ( left only on the first row ), the 4-bit residual is
+ * zig-zag mapped to 0 - 15 and coded as unary quotient + k-bit remainder with
+ * the k giving the fewest bits for that row. Rows that would not shrink are
+ * stored raw, so the output is never much larger than the image.
+ */
+
+static void r307_imgcodec_unpack(const uint8_t *restrict packed, uint8_t *restrict line)
+{
+    for(int i=0; i<R307_IMAGE_ROW_BYTES; i++)
+    {
+        line[2 * i] = packed[i] >> 4;
+        line[2 * i + 1] = packed[i] & 0x0F;
+    }
+}
+
+static void r307_imgcodec_pack(const uint8_t *restrict line, uint8_t *restrict packed)
+{
+    for(int i=0; i<R307_IMAGE_ROW_BYTES; i++)
+    {
+        packed[i] = (line[2 * i] << 4) | line[2 * i + 1];
+    }
+}
+
+static inline uint8_t r307_imgcodec_zigzag(int difference)
+{
+    const int residual = ((difference & 0x0F) ^ 0x08) - 0x08;                          //++ Wrap to -8 .. 7
+    return (uint8_t)((residual << 1) ^ (residual >> 31));
+}
+
+static inline uint8_t r307_imgcodec_unzigzag(int predicted, int zigzag)
+{
+    const int residual = (zigzag >> 1) ^ -(zigzag & 1);
+    return (uint8_t)((predicted + residual) & 0x0F);
+}
+
+static void r307_imgcodec_residuals(const uint8_t *restrict line, const uint8_t *restrict above, uint8_t *restrict residual, int first_row)
+{
+    if(first_row)
+    {
+        residual[0] = r307_imgcodec_zigzag(line[0]);
+        for(int x=1; x<R307_IMAGE_WIDTH; x++)
+        {
+            residual[x] = r307_imgcodec_zigzag(line[x] - line[x - 1]);
+        }
+    }
+    else
+    {
+        residual[0] = r307_imgcodec_zigzag(line[0] - above[0]);
+        for(int x=1; x<R307_IMAGE_WIDTH; x++)                                           //++ Depends on original pixels only : vectorizable
+        {
+            residual[x] = r307_imgcodec_zigzag(line[x] - ((line[x - 1] + above[x] + 1) >> 1));
+        }
+    }
+}
+
+static void r307_imgcodec_flush_out(r307_imgcodec_encoder_t *encoder)
+{
+    if(encoder->out_fill == 0)
+    {
+        return;
+    }
+    if(!encoder->error && encoder->sink(encoder->out, encoder->out_fill, encoder->sink_arg) != 0)
+    {
+        encoder->error = 1;
+    }
+    encoder->bytes_out += encoder->out_fill;
+    encoder->out_fill = 0;
+}
+
+static void r307_imgcodec_put(r307_imgcodec_encoder_t *encoder, uint32_t value, int bits)
+{
+    encoder->bit_buffer = (encoder->bit_buffer << bits) | value;
+    encoder->bit_count += bits;
+    while(encoder->bit_count >= 8)
+    {
+        encoder->bit_count -= 8;
+        encoder->out[encoder->out_fill++] = (encoder->bit_buffer >> encoder->bit_count) & 0xFF;
+        if(encoder->out_fill == R307_IMGCODEC_OUT_SIZE)
+        {
+            r307_imgcodec_flush_out(encoder);
+        }
+    }
+}
+
+static void r307_imgcodec_encode_row(r307_imgcodec_encoder_t *encoder)
+{
+    uint8_t *line = encoder->line[encoder->row & 1];
+    const uint8_t *above = encoder->line[(encoder->row + 1) & 1];
+    uint32_t cost[R307_IMGCODEC_MAX_K + 1] = {0};
+    uint32_t total = 0;
+    int k = 0;
+
+    r307_imgcodec_unpack(encoder->packed_row, line);
+    r307_imgcodec_residuals(line, above, encoder->residual, encoder->row == 0);
+
+    for(int x=0; x<R307_IMAGE_WIDTH; x++)                                               //++ Bits of the row for every k ( unary stop bit & remainder added below )
+    {
+        const uint32_t value = encoder->residual[x];
+        total += value;
+        cost[0] += value;
+        cost[1] += value >> 1;
+        cost[2] += value >> 2;
+        cost[3] += value >> 3;
+    }
+
+    for(int i=1; i<=R307_IMGCODEC_MAX_K; i++)
+    {
+        if(cost[i] + i * R307_IMAGE_WIDTH < cost[k] + k * R307_IMAGE_WIDTH)
+        {
+            k = i;
+        }
+    }
+
+    if(total == 0)
+    {
+        r307_imgcodec_put(encoder, R307_IMGCODEC_ZERO_ROW, 3);
+    }
+    else if(cost[k] + (k + 1) * R307_IMAGE_WIDTH >= 4 * R307_IMAGE_WIDTH)
+    {
+        r307_imgcodec_put(encoder, R307_IMGCODEC_RAW_ROW, 3);
+        for(int x=0; x<R307_IMAGE_WIDTH; x++)
+        {
+            r307_imgcodec_put(encoder, line[x], 4);
+        }
+    }
+    else
+    {
+        r307_imgcodec_put(encoder, k, 3);
+        for(int x=0; x<R307_IMAGE_WIDTH; x++)
+        {
+            const uint32_t value = encoder->residual[x];
+            const int quotient = value >> k;
+            r307_imgcodec_put(encoder, ((1u << quotient) - 1) << 1, quotient + 1);     //++ Quotient ones, then a zero
+            if(k > 0)
+            {
+                r307_imgcodec_put(encoder, value & ((1u << k) - 1), k);
+            }
+        }
+    }
+
+    encoder->row++;
+}
+
+void r307_imgcodec_encoder_begin(r307_imgcodec_encoder_t *encoder, r307_data_cb_t sink, void *sink_arg)
+{
+    memset(encoder, 0, sizeof(*encoder));
+    encoder->sink = sink;
+    encoder->sink_arg = sink_arg;
+
+    r307_imgcodec_put(encoder, 'R', 8);
+    r307_imgcodec_put(encoder, '3', 8);
+    r307_imgcodec_put(encoder, 'I', 8);
+    r307_imgcodec_put(encoder, R307_IMGCODEC_VERSION, 8);
+    r307_imgcodec_put(encoder, R307_IMAGE_WIDTH, 16);
+    r307_imgcodec_put(encoder, R307_IMAGE_HEIGHT, 16);
+}
+
+int r307_imgcodec_encode(const uint8_t data[], int length, void *arg)
+{
+    r307_imgcodec_encoder_t *encoder = (r307_imgcodec_encoder_t *)arg;
+
+    encoder->bytes_in += length;
+    while(length > 0)                                                                   //++ Data Packages need not be aligned to rows
+    {
+        if(encoder->row >= R307_IMAGE_HEIGHT)
+        {
+            return 1;
+        }
+
+        int chunk = R307_IMAGE_ROW_BYTES - encoder->row_fill;
+        chunk = chunk < length ? chunk : length;
+        memcpy(&encoder->packed_row[encoder->row_fill], data, chunk);
+        encoder->row_fill += chunk;
+        data += chunk;
+        length -= chunk;
+
+        if(encoder->row_fill == R307_IMAGE_ROW_BYTES)
+        {
+            r307_imgcodec_encode_row(encoder);
+            encoder->row_fill = 0;
+        }
+    }
+
+    return encoder->error;
+}
+
+int r307_imgcodec_encoder_finish(r307_imgcodec_encoder_t *encoder)
+{
+    if(encoder->bit_count > 0)
+    {
+        r307_imgcodec_put(encoder, 0, 8 - encoder->bit_count);                          //++ Pad the last byte
+    }
+    r307_imgcodec_flush_out(encoder);
+
+    if(encoder->error || encoder->row != R307_IMAGE_HEIGHT)
+    {
+        return -1;
+    }
+
+    return encoder->bytes_out;
+}
+
+typedef struct
+{
+    r307_imgcodec_read_cb_t read;
+    void *read_arg;
+    uint8_t in[R307_IMGCODEC_IN_SIZE];
+    int in_fill;
+    int in_position;
+    uint32_t bit_buffer;
+    int bit_count;
+} r307_imgcodec_reader_t;
+
+static int r307_imgcodec_get(r307_imgcodec_reader_t *reader, int bits)
+{
+    while(reader->bit_count < bits)
+    {
+        if(reader->in_position == reader->in_fill)
+        {
+            reader->in_fill = reader->read(reader->in, sizeof(reader->in), reader->read_arg);
+            reader->in_position = 0;
+            if(reader->in_fill <= 0)
+            {
+                reader->in_fill = 0;
+                return -1;                                                              //++ Input ended in the middle of the image
+            }
+        }
+        reader->bit_buffer = (reader->bit_buffer << 8) | reader->in[reader->in_position++];
+        reader->bit_count += 8;
+    }
+
+    reader->bit_count -= bits;
+    return (reader->bit_buffer >> reader->bit_count) & ((1u << bits) - 1);
+}
+
+int r307_imgcodec_decode(r307_imgcodec_read_cb_t read, void *read_arg, r307_data_cb_t sink, void *sink_arg)
+{
+    r307_imgcodec_reader_t reader = {.read = read, .read_arg = read_arg};
+    uint8_t line[2][R307_IMAGE_WIDTH];
+    uint8_t packed_row[R307_IMAGE_ROW_BYTES];
+
+    if(r307_imgcodec_get(&reader, 8) != 'R' || r307_imgcodec_get(&reader, 8) != '3' || r307_imgcodec_get(&reader, 8) != 'I'
+       || r307_imgcodec_get(&reader, 8) != R307_IMGCODEC_VERSION
+       || r307_imgcodec_get(&reader, 16) != R307_IMAGE_WIDTH || r307_imgcodec_get(&reader, 16) != R307_IMAGE_HEIGHT)
+    {
+        ESP_LOGE(R307_IMGCODEC, "Not an encoded image");
+        return 1;
+    }
+
+    for(int row=0; row<R307_IMAGE_HEIGHT; row++)
+    {
+        uint8_t *current = line[row & 1];
+        const uint8_t *above = line[(row + 1) & 1];
+        const int mode = r307_imgcodec_get(&reader, 3);
+
+        if(mode < 0 || (mode > R307_IMGCODEC_MAX_K && mode != R307_IMGCODEC_ZERO_ROW && mode != R307_IMGCODEC_RAW_ROW))
+        {
+            return 1;
+        }
+
+        for(int x=0; x<R307_IMAGE_WIDTH && mode == R307_IMGCODEC_RAW_ROW; x++)
+        {
+            const int pixel = r307_imgcodec_get(&reader, 4);
+            if(pixel < 0)
+            {
+                return 1;
+            }
+            current[x] = pixel;
+        }
+
+        for(int x=0; x<R307_IMAGE_WIDTH && mode != R307_IMGCODEC_RAW_ROW; x++)
+        {
+            int zigzag = 0;
+            if(mode != R307_IMGCODEC_ZERO_ROW)
+            {
+                int quotient = 0;
+                int bit = 0;
+                while((bit = r307_imgcodec_get(&reader, 1)) == 1 && quotient < 16)
+                {
+                    quotient++;
+                }
+                if(bit != 0)
+                {
+                    return 1;
+                }
+                const int remainder = mode ? r307_imgcodec_get(&reader, mode) : 0;
+                zigzag = (quotient << mode) | remainder;
+                if(remainder < 0 || zigzag > 15)
+                {
+                    return 1;
+                }
+            }
+
+            int predicted = 0;
+            if(row == 0)
+            {
+                predicted = x ? current[x - 1] : 0;
+            }
+            else
+            {
+                predicted = x ? (current[x - 1] + above[x] + 1) >> 1 : above[0];
+            }
+            current[x] = r307_imgcodec_unzigzag(predicted, zigzag);
+        }
+
+        r307_imgcodec_pack(current, packed_row);
+        if(sink(packed_row, sizeof(packed_row), sink_arg) != 0)
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+uint8_t r307_imgcodec_up_image(char r307_address[], r307_data_cb_t sink, void *sink_arg, int *encoded_length)
+{
+    r307_imgcodec_encoder_t *encoder = (r307_imgcodec_encoder_t *)malloc(sizeof(r307_imgcodec_encoder_t));
+    uint8_t confirmation_code = 0;
+
+    if(encoder == NULL)
+    {
+        return 0x01;
+    }
+
+    r307_imgcodec_encoder_begin(encoder, sink, sink_arg);
+    confirmation_code = r307_up_image(r307_address, r307_imgcodec_encode, encoder);    //++ Rows are encoded while the packages arrive
+    *encoded_length = r307_imgcodec_encoder_finish(encoder);
+    if(confirmation_code == 0x00 && *encoded_length < 0)
+    {
+        confirmation_code = 0x01;
+    }
+    free(encoder);
+
+    return confirmation_code;
+}
+
+uint8_t r307_imgcodec_down_image(char r307_address[], r307_imgcodec_read_cb_t read, void *read_arg)
+{
+    r307_data_writer_t writer;
+    uint8_t confirmation_code = 0;
+
+    r307_link_acquire();                                                                //++ Data Packages must follow DownImage without another task's frames
+    confirmation_code = r307_down_image(r307_address, &writer);
+    if(confirmation_code == 0x00 && r307_get_response()->received)
+    {
+        confirmation_code = r307_imgcodec_decode(read, read_arg, r307_data_writer_write, &writer) == 0 ? 0x00 : 0x01;  //++ Rows go out as Data Packages as soon as they are decoded
+        if(confirmation_code != 0x00)
+        {
+            ESP_LOGE(R307_IMGCODEC, "Image did not decode, %d bytes padded", writer.remaining);
+            r307_data_writer_pad(&writer);                                              //++ Module still waits for End of Data, don't leave it mid-transfer
+            r307_invalidate_char_buffers();                                             //++ ImageBuffer holds a partly padded image now
+        }
+    }
+    r307_link_release();
+
+    return confirmation_code;
+}
+
+typedef struct
+{
+    uint8_t *data;
+    int size;
+    int position;
+    const uint8_t *reference;
+    int mismatch;
+} r307_imgcodec_bench_buffer_t;
+
+static int r307_imgcodec_bench_write(const uint8_t data[], int length, void *arg)
+{
+    r307_imgcodec_bench_buffer_t *buffer = (r307_imgcodec_bench_buffer_t *)arg;
+
+    if(buffer->position + length > buffer->size)
+    {
+        return 1;
+    }
+    memcpy(&buffer->data[buffer->position], data, length);
+    buffer->position += length;
+
+    return 0;
+}
+
+static int r307_imgcodec_bench_read(uint8_t data[], int length, void *arg)
+{
+    r307_imgcodec_bench_buffer_t *buffer = (r307_imgcodec_bench_buffer_t *)arg;
+    const int chunk = buffer->size - buffer->position < length ? buffer->size - buffer->position : length;
+
+    memcpy(data, &buffer->data[buffer->position], chunk);
+    buffer->position += chunk;
+
+    return chunk;
+}
+
+static int r307_imgcodec_bench_compare(const uint8_t data[], int length, void *arg)
+{
+    r307_imgcodec_bench_buffer_t *buffer = (r307_imgcodec_bench_buffer_t *)arg;
+
+    buffer->mismatch |= memcmp(data, &buffer->reference[buffer->position], length) != 0;
+    buffer->position += length;
+
+    return 0;
+}
+
+void r307_imgcodec_bench(const uint8_t image[], r307_imgcodec_bench_t *result)
+{
+    r307_imgcodec_encoder_t *encoder = (r307_imgcodec_encoder_t *)malloc(sizeof(r307_imgcodec_encoder_t));
+    r307_imgcodec_bench_buffer_t encoded = {.size = R307_IMAGE_SIZE + R307_IMAGE_HEIGHT + 64};  //++ Worst case is every row raw + row modes & header
+    r307_imgcodec_bench_buffer_t decoded = {.reference = image};
+    const int packet_size = r307_get_packet_size();
+
+    memset(result, 0, sizeof(*result));
+    encoded.data = (uint8_t *)malloc(encoded.size);
+    if(encoder == NULL || encoded.data == NULL)
+    {
+        free(encoder);
+        free(encoded.data);
+        return;
+    }
+
+    int64_t start_time = esp_timer_get_time();
+    r307_imgcodec_encoder_begin(encoder, r307_imgcodec_bench_write, &encoded);
+    for(int offset=0; offset<R307_IMAGE_SIZE; offset+=packet_size)                      //++ Fed in Data Package sized chunks like a real upload
+    {
+        r307_imgcodec_encode(&image[offset], R307_IMAGE_SIZE - offset < packet_size ? R307_IMAGE_SIZE - offset : packet_size, encoder);
+    }
+    const int encoded_length = r307_imgcodec_encoder_finish(encoder);
+    result->encode_us = esp_timer_get_time() - start_time;
+
+    encoded.size = encoded.position;
+    encoded.position = 0;
+    start_time = esp_timer_get_time();
+    const int decode_error = r307_imgcodec_decode(r307_imgcodec_bench_read, &encoded, r307_imgcodec_bench_compare, &decoded);
+    result->decode_us = esp_timer_get_time() - start_time;
+
+    result->raw_bytes = R307_IMAGE_SIZE;
+    result->encoded_bytes = encoded_length > 0 ? encoded_length : 0;
+    result->ratio_x100 = result->encoded_bytes ? (100 * result->raw_bytes) / result->encoded_bytes : 0;
+    result->encode_kbps = result->encode_us > 0 ? (uint32_t)((int64_t)result->raw_bytes * 1000000 / 1024 / result->encode_us) : 0;
+    result->lossless = encoded_length > 0 && !decode_error && !decoded.mismatch && decoded.position == R307_IMAGE_SIZE;
+
+    ESP_LOGI(R307_IMGCODEC, "%u -> %u bytes ( ratio %u.%02u ), encode %lld us ( %u KB/s ), decode %lld us, lossless %d",
+             (unsigned)result->raw_bytes, (unsigned)result->encoded_bytes, (unsigned)(result->ratio_x100 / 100), (unsigned)(result->ratio_x100 % 100),
+             (long long)result->encode_us, (unsigned)result->encode_kbps, (long long)result->decode_us, result->lossless);
+
+    free(encoded.data);
+    free(encoder);
+}
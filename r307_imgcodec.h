@@ -0,0 +1,134 @@
+#include <stdint.h>
+
+#include "r307.h"
+#include "r307_image.h"
+
+#ifndef r307_imgcodec_H
+#define r307_imgcodec_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define R307_IMGCODEC_HEADER_SIZE (8)           //++ 'R' '3' 'I' Version, Width ( 2 Bytes ), Height ( 2 Bytes )
+#define R307_IMGCODEC_OUT_SIZE (64)             //++ Encoded bytes buffered before calling the sink
+
+/**
+ * @brief CALLBACK PULLING ENCODED BYTES FOR THE DECODER
+ *
+ * @param data BUFFER TO FILL
+ * @param length SIZE OF THE BUFFER
+ * @param arg USER ARGUMENT
+ * @return RETURNS NUMBER OF BYTES PUT IN data ( 0 AT THE END OF THE INPUT )
+ */
+typedef int (*r307_imgcodec_read_cb_t)(uint8_t data[], int length, void *arg);
+
+/**
+ * @brief STREAMING STATE OF THE IMAGE ENCODER
+ */
+typedef struct
+{
+    r307_data_cb_t sink;                                        //++ Receives encoded bytes
+    void *sink_arg;
+    uint8_t packed_row[R307_IMAGE_ROW_BYTES];                   //++ Bytes of the row being assembled
+    uint8_t line[2][R307_IMAGE_WIDTH];                          //++ Current & previous unpacked rows
+    uint8_t residual[R307_IMAGE_WIDTH];                         //++ Zig-zag mapped prediction residuals of the current row
+    uint8_t out[R307_IMGCODEC_OUT_SIZE];                        //++ Encoded bytes waiting for the sink
+    uint32_t bit_buffer;
+    int bit_count;
+    int out_fill;
+    uint16_t row_fill;
+    uint16_t row;
+    uint32_t bytes_in;                                          //++ Packed image bytes fed
+    uint32_t bytes_out;                                         //++ Encoded bytes given to the sink
+    int error;                                                  //++ 1 once the sink failed
+} r307_imgcodec_encoder_t;
+
+/**
+ * @brief RESULT OF THE ENCODER BENCHMARK
+ */
+typedef struct
+{
+    uint32_t raw_bytes;                     //++ Packed image size
+    uint32_t encoded_bytes;                 //++ Encoded size including header
+    uint32_t ratio_x100;                    //++ raw_bytes / encoded_bytes x 100
+    int64_t encode_us;                      //++ Time to encode the image
+    uint32_t encode_kbps;                   //++ Encode throughput in KB of raw image per second
+    int64_t decode_us;                      //++ Time to decode the image
+    uint8_t lossless;                       //++ 1 if decoding gave back the exact image
+} r307_imgcodec_bench_t;
+
+/**
+ * @brief FUNCTION TO START ENCODING AN IMAGE, WRITES THE HEADER TO THE SINK
+ *
+ * @param encoder ENCODER TO INITIALIZE
+ * @param sink RECEIVES ENCODED BYTES ( E.G. FLASH OR NETWORK WRITER )
+ * @param sink_arg USER ARGUMENT PASSED TO THE SINK
+ * @return
+ */
+void r307_imgcodec_encoder_begin(r307_imgcodec_encoder_t *encoder, r307_data_cb_t sink, void *sink_arg);
+
+/**
+ * @brief FUNCTION TO FEED PACKED IMAGE BYTES AS THEY ARRIVE, EACH COMPLETE ROW IS ENCODED IMMEDIATELY
+ *
+ * @param data PACKED IMAGE BYTES ( CONTENTS OF A DATA PACKAGE )
+ * @param length NUMBER OF BYTES IN data
+ * @param arg ENCODER ( r307_imgcodec_encoder_t * ), SO IT CAN BE PASSED AS r307_data_cb_t
+ * @return RETURNS 0 TO CONTINUE, 1 ON SINK ERROR OR TOO MANY BYTES
+ */
+int r307_imgcodec_encode(const uint8_t data[], int length, void *arg);
+
+/**
+ * @brief FUNCTION TO FLUSH THE LAST ENCODED BITS TO THE SINK
+ *
+ * @param encoder ENCODER FED WITH THE WHOLE IMAGE
+ * @return RETURNS TOTAL ENCODED BYTES, OR -1 IF THE IMAGE WAS INCOMPLETE OR THE SINK FAILED
+ */
+int r307_imgcodec_encoder_finish(r307_imgcodec_encoder_t *encoder);
+
+/**
+ * @brief FUNCTION TO DECODE AN ENCODED IMAGE, PACKED ROWS ARE GIVEN TO THE SINK ONE BY ONE
+ *
+ * @param read PULLS ENCODED BYTES
+ * @param read_arg USER ARGUMENT PASSED TO read
+ * @param sink RECEIVES EVERY DECODED ROW ( R307_IMAGE_ROW_BYTES PACKED BYTES )
+ * @param sink_arg USER ARGUMENT PASSED TO THE SINK
+ * @return RETURNS 0 ON SUCCESS, 1 ON CORRUPT INPUT OR SINK ERROR
+ */
+int r307_imgcodec_decode(r307_imgcodec_read_cb_t read, void *read_arg, r307_data_cb_t sink, void *sink_arg);
+
+/**
+ * @brief FUNCTION TO UPLOAD IMG_BUFFER ( UpImage ) & ENCODE IT WHILE THE DATA PACKAGES ARRIVE
+ *
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @param sink RECEIVES ENCODED BYTES
+ * @param sink_arg USER ARGUMENT PASSED TO THE SINK
+ * @param encoded_length FILLED WITH TOTAL ENCODED BYTES
+ * @return RETURNS RECEIVED CONFIRMATION CODE FROM MODULE, OR 0x01 IF THE TRANSFER OR THE SINK FAILED
+ */
+uint8_t r307_imgcodec_up_image(char r307_address[], r307_data_cb_t sink, void *sink_arg, int *encoded_length);
+
+/**
+ * @brief FUNCTION TO DECODE AN ENCODED IMAGE STRAIGHT INTO IMG_BUFFER ( DownImage )
+ *
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @param read PULLS ENCODED BYTES
+ * @param read_arg USER ARGUMENT PASSED TO read
+ * @return RETURNS RECEIVED CONFIRMATION CODE FROM MODULE, OR 0x01 IF THE INPUT WAS CORRUPT ( THE TRANSFER IS PADDED WITH ZEROS, DON'T USE IMG_BUFFER )
+ */
+uint8_t r307_imgcodec_down_image(char r307_address[], r307_imgcodec_read_cb_t read, void *read_arg);
+
+/**
+ * @brief FUNCTION TO MEASURE COMPRESSION RATIO & ENCODE THROUGHPUT ON A PACKED IMAGE
+ *
+ * @param image PACKED IMAGE OF R307_IMAGE_SIZE BYTES ( E.G. CAPTURED WITH r307_up_image )
+ * @param result FILLED WITH SIZES, RATIO, TIMINGS & LOSSLESS CHECK
+ * @return
+ */
+void r307_imgcodec_bench(const uint8_t image[], r307_imgcodec_bench_t *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // r307_imgcodec_H
@@ -0,0 +1,222 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include "string.h"
+
+#include "esp_log.h"
+
+#include "r307.h"
+#include "r307_library.h"
+
+static const char *R307_LIBRARY = "R307_LIBRARY";   //++ Library TAG
+
+static int r307_library_bit(const uint8_t bits[], int page)
+{
+    return (bits[page / 8] >> (page % 8)) & 0x01;
+}
+
+static void r307_library_set_bit(uint8_t bits[], int page, int value)
+{
+    if(value)
+    {
+        bits[page / 8] |= 1 << (page % 8);
+    }
+    else
+    {
+        bits[page / 8] &= ~(1 << (page % 8));
+    }
+}
+
+static int r307_library_compare_pages(const void *a, const void *b)
+{
+    return (int)*(const uint16_t *)a - (int)*(const uint16_t *)b;
+}
+
+static uint8_t r307_library_delete_range(char r307_address[], int start, int run, r307_library_stats_t *stats)
+{
+    char page_id[2] = {start >> 8, start & 0xFF};
+    char number_of_templates[2] = {run >> 8, run & 0xFF};
+    uint8_t confirmation_code = 0;
+
+    r307_link_acquire();                                                                //++ Acknowledge must be read before another task's command replaces it
+    confirmation_code = DeletChar(r307_address, page_id, number_of_templates);
+    confirmation_code = r307_get_response()->received ? confirmation_code : 0x01;
+    r307_link_release();
+    if(confirmation_code == 0x01)
+    {
+        return 0x01;
+    }
+    if(confirmation_code == 0x00)
+    {
+        stats->deleted += run;
+        stats->delete_commands++;
+    }
+
+    return confirmation_code;
+}
+
+static uint8_t r307_library_scan_pages(char r307_address[], uint16_t library_size, uint8_t occupied[])
+{
+    char buffer_id[1] = {0x01};
+    uint8_t confirmation_code = 0x00;
+
+    memset(occupied, 0, (library_size + 7) / 8);
+    for(int page=0; page<library_size; page++)
+    {
+        char page_id[2] = {page >> 8, page & 0xFF};
+
+        r307_link_acquire();
+        confirmation_code = LoadChar(r307_address, buffer_id, page_id);
+        confirmation_code = r307_get_response()->received ? confirmation_code : 0x01;
+        r307_link_release();
+        if(confirmation_code == 0x01)
+        {
+            return 0x01;
+        }
+        if(confirmation_code == 0x00)
+        {
+            r307_library_set_bit(occupied, page, 1);
+        }
+        else if(confirmation_code != 0x0C)                                              //++ 0x0C : No valid template on this page
+        {
+            return confirmation_code;
+        }
+    }
+
+    return 0x00;
+}
+
+uint8_t r307_library_scan(char r307_address[], uint16_t library_size, uint8_t occupied[])
+{
+    const int bitmap_size = (library_size + 7) / 8;
+    uint8_t confirmation_code = 0x00;
+
+    for(int offset=0; offset<bitmap_size; offset+=R307_INDEX_TABLE_SIZE)
+    {
+        char index_page[1] = {offset / R307_INDEX_TABLE_SIZE};
+        const int length = (bitmap_size - offset < R307_INDEX_TABLE_SIZE) ? bitmap_size - offset : R307_INDEX_TABLE_SIZE;
+
+        r307_link_acquire();                                                            //++ index_table must be copied before another task's command replaces it
+        confirmation_code = ReadIndexTable(r307_address, index_page);
+        confirmation_code = r307_get_response()->received ? confirmation_code : 0x01;
+        if(confirmation_code == 0x00)
+        {
+            memcpy(&occupied[offset], r307_get_response()->index_table, length);
+        }
+        r307_link_release();
+        if(confirmation_code != 0x00)
+        {
+            ESP_LOGW(R307_LIBRARY, "ReadIndexTable failed, code 0x%02X, scanning page by page", confirmation_code);
+            return r307_library_scan_pages(r307_address, library_size, occupied);
+        }
+    }
+    for(int page=library_size; page<bitmap_size * 8; page++)                           //++ Pages past the library in the last byte
+    {
+        r307_library_set_bit(occupied, page, 0);
+    }
+
+    return 0x00;
+}
+
+uint8_t r307_library_delete(char r307_address[], uint16_t page_ids[], int count, r307_library_stats_t *stats)
+{
+    r307_library_stats_t library_stats = {0};
+    uint8_t confirmation_code = 0x00;
+    int start = 0;
+
+    qsort(page_ids, count, sizeof(page_ids[0]), r307_library_compare_pages);
+    while(start < count && confirmation_code == 0x00)
+    {
+        int end = start + 1;
+        int run = 1;
+
+        while(end < count && page_ids[end] <= page_ids[start] + run)                    //++ Duplicates stay in the run, the next page extends it
+        {
+            run = page_ids[end] - page_ids[start] + 1;
+            end++;
+        }
+        library_stats.requested += run;
+        confirmation_code = r307_library_delete_range(r307_address, page_ids[start], run, &library_stats);
+        start = end;
+    }
+
+    ESP_LOGI(R307_LIBRARY, "Deleted %d pages with %d DeletChar commands", library_stats.deleted, library_stats.delete_commands);
+    if(stats)
+    {
+        *stats = library_stats;
+    }
+
+    return confirmation_code;
+}
+
+uint8_t r307_library_compact(char r307_address[], uint16_t library_size, uint8_t occupied[], uint16_t remap[], r307_library_stats_t *stats)
+{
+    char buffer_id[1] = {0x01};
+    r307_library_stats_t library_stats = {0};
+    uint8_t confirmation_code = 0x00;
+    int hole = 0;
+    int last = library_size - 1;
+    int highest = 0;
+
+    for(int page=0; page<library_size; page++)
+    {
+        remap[page] = r307_library_bit(occupied, page) ? page : R307_LIBRARY_EMPTY;
+    }
+    while(last >= 0 && !r307_library_bit(occupied, last))
+    {
+        last--;
+    }
+    highest = last;
+
+    while(1)
+    {
+        while(hole < last && r307_library_bit(occupied, hole))
+        {
+            hole++;
+        }
+        if(hole >= last)
+        {
+            break;
+        }
+
+        char from_page[2] = {last >> 8, last & 0xFF};
+        char to_page[2] = {hole >> 8, hole & 0xFF};
+        r307_link_acquire();                                                            //++ LoadChar & Store of one move must not be split by another task
+        confirmation_code = LoadChar(r307_address, buffer_id, from_page);               //++ Highest template goes to the lowest hole
+        if(confirmation_code == 0x00 && r307_get_response()->received)
+        {
+            confirmation_code = Store(r307_address, buffer_id, to_page);                //++ Old page is only deleted after the copy is stored
+        }
+        confirmation_code = (confirmation_code == 0x00 && !r307_get_response()->received) ? 0x01 : confirmation_code;
+        r307_link_release();
+        if(confirmation_code != 0x00)
+        {
+            ESP_LOGE(R307_LIBRARY, "Moving page %d to %d failed, code 0x%02X", last, hole, confirmation_code);
+            break;
+        }
+
+        remap[last] = hole;
+        r307_library_set_bit(occupied, hole, 1);
+        r307_library_set_bit(occupied, last, 0);
+        library_stats.moved++;
+        while(last >= 0 && !r307_library_bit(occupied, last))
+        {
+            last--;
+        }
+    }
+
+    if(library_stats.moved)                                                             //++ Everything above the new top was moved away or empty : one DeletChar
+    {
+        const uint8_t delete_code = r307_library_delete_range(r307_address, last + 1, highest - last, &library_stats);
+
+        confirmation_code = confirmation_code ? confirmation_code : delete_code;
+    }
+    library_stats.used_pages = last + 1;
+
+    ESP_LOGI(R307_LIBRARY, "Moved %d templates, library now uses %d pages", library_stats.moved, library_stats.used_pages);
+    if(stats)
+    {
+        *stats = library_stats;
+    }
+
+    return confirmation_code;
+}
@@ -0,0 +1,63 @@
+#include <stdint.h>
+
+#include "r307.h"
+
+#ifndef r307_library_H
+#define r307_library_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define R307_LIBRARY_EMPTY (0xFFFF)             //++ Remap entry of a page that held no template
+
+/**
+ * @brief COUNTERS OF THE LAST BATCH DELETE OR COMPACTION
+ */
+typedef struct
+{
+    uint16_t requested;                                         //++ Distinct pages asked for
+    uint16_t deleted;                                           //++ Pages covered by DeletChar ranges
+    uint16_t delete_commands;                                   //++ DeletChar commands sent ( one per contiguous range )
+    uint16_t moved;                                             //++ Templates relocated by the compaction
+    uint16_t used_pages;                                        //++ Pages Search has to scan after the operation ( highest occupied page + 1 )
+} r307_library_stats_t;
+
+/**
+ * @brief FUNCTION TO FIND THE OCCUPIED PAGES OF THE LIBRARY, ONE ReadIndexTable PER 256 PAGES ( LoadChar PER PAGE IF UNSUPPORTED )
+ *
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @param library_size PAGES TO SCAN
+ * @param occupied BITMAP OF ( library_size + 7 ) / 8 BYTES, BIT n SET IF PAGE n HOLDS A TEMPLATE
+ * @return RETURNS 0x00 ON SUCCESS, ELSE CONFIRMATION CODE OF THE FAILED COMMAND ( 0x01 IF UNANSWERED )
+ */
+uint8_t r307_library_scan(char r307_address[], uint16_t library_size, uint8_t occupied[]);
+
+/**
+ * @brief FUNCTION TO DELETE AN ARBITRARY SET OF PAGES WITH THE FEWEST DeletChar COMMANDS
+ *
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @param page_ids PAGES TO DELETE, IN ANY ORDER & WITH DUPLICATES ( SORTED IN PLACE )
+ * @param count NUMBER OF ENTRIES IN page_ids
+ * @param stats FILLED WITH THE COUNTERS OF THIS DELETE ( MAY BE NULL )
+ * @return RETURNS 0x00 ON SUCCESS, ELSE CONFIRMATION CODE OF THE FAILED DeletChar
+ */
+uint8_t r307_library_delete(char r307_address[], uint16_t page_ids[], int count, r307_library_stats_t *stats);
+
+/**
+ * @brief FUNCTION TO MOVE TEMPLATES DOWN INTO EMPTY PAGES SO THE LIBRARY IS CONTIGUOUS FROM PAGE 0
+ *
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @param library_size PAGES IN THE LIBRARY
+ * @param occupied OCCUPANCY BITMAP ( r307_library_scan ), UPDATED AS TEMPLATES MOVE
+ * @param remap library_size ENTRIES, FILLED WITH THE NEW PAGE OF EVERY OLD PAGE ( R307_LIBRARY_EMPTY IF IT WAS EMPTY )
+ * @param stats FILLED WITH THE COUNTERS OF THIS COMPACTION ( MAY BE NULL )
+ * @return RETURNS 0x00 ON SUCCESS, ELSE CONFIRMATION CODE OF THE FAILED COMMAND ( remap IS VALID FOR THE MOVES DONE )
+ */
+uint8_t r307_library_compact(char r307_address[], uint16_t library_size, uint8_t occupied[], uint16_t remap[], r307_library_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // r307_library_H
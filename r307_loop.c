@@ -0,0 +1,168 @@
+#include <stdint.h>
+#include "string.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+
+#include "r307.h"
+#include "r307_loop.h"
+
+#define R307_LOOP_STACK_SIZE (4096)             //++ Default stack size of the loop task
+#define R307_LOOP_PRIORITY (5)                  //++ Default priority of the loop task
+#define R307_LOOP_POLL_MS (50)                  //++ Default pause between two GenImg without a finger
+
+static const char *R307_LOOP = "R307_LOOP";     //++ Loop TAG
+
+typedef struct
+{
+    r307_identify_result_t result;
+    int64_t ready_us;                           //++ Time the result was queued
+} r307_loop_item_t;
+
+static r307_loop_config_t loop_config;          //++ Active loop configuration
+static QueueHandle_t loop_queue;                //++ Holds at most one pending result
+static SemaphoreHandle_t loop_slot;             //++ Given when the application took the pending result
+static SemaphoreHandle_t loop_exited;           //++ Given by the loop task right before it deletes itself
+static TaskHandle_t loop_task_handle;           //++ Loop task
+static volatile uint8_t loop_running;           //++ 1 while the loop task should keep running
+static volatile uint8_t loop_consumer_waiting;  //++ 1 while the application is blocked in r307_loop_next
+static r307_loop_stats_t loop_stats;
+
+static void r307_loop_wait_lift(void)
+{
+    uint8_t confirmation_code = 0x00;
+
+    while(loop_running && confirmation_code != 0x02)                                    //++ Same finger must not be identified twice
+    {
+        vTaskDelay(pdMS_TO_TICKS(loop_config.poll_ms));
+        confirmation_code = GenImg(loop_config.r307_address);
+        loop_stats.lift_polls++;
+    }
+}
+
+static void r307_loop_task(void *arg)
+{
+    r307_loop_item_t item;
+
+    while(loop_running)
+    {
+        if(xSemaphoreTake(loop_slot, portMAX_DELAY) != pdTRUE || !loop_running)         //++ Never capture more than one finger ahead of the application
+        {
+            continue;
+        }
+
+        do
+        {
+            r307_identify(loop_config.r307_address, loop_config.library_size, &item.result);
+            if(item.result.failed_instruction == 0x01 && item.result.confirmation_code == 0x02)
+            {
+                loop_stats.empty_polls++;
+                vTaskDelay(pdMS_TO_TICKS(loop_config.poll_ms));
+            }
+        } while(loop_running && item.result.failed_instruction == 0x01 && item.result.confirmation_code == 0x02);
+
+        if(!loop_running)
+        {
+            break;
+        }
+
+        item.ready_us = esp_timer_get_time();
+        loop_stats.speculative = loop_stats.speculative + !loop_consumer_waiting;
+        xQueueSend(loop_queue, &item, portMAX_DELAY);                                   //++ Slot guarantees the queue has room
+        r307_loop_wait_lift();
+    }
+
+    xSemaphoreGive(loop_exited);
+    vTaskDelete(NULL);
+}
+
+esp_err_t r307_loop_start(const r307_loop_config_t *config)
+{
+    if(config == NULL || loop_task_handle != NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    memcpy(&loop_config, config, sizeof(loop_config));
+    loop_config.poll_ms = loop_config.poll_ms ? loop_config.poll_ms : R307_LOOP_POLL_MS;
+
+    if(loop_queue == NULL)
+    {
+        loop_queue = xQueueCreate(1, sizeof(r307_loop_item_t));
+        loop_slot = xSemaphoreCreateBinary();
+        loop_exited = xSemaphoreCreateBinary();
+        if(loop_queue == NULL || loop_slot == NULL || loop_exited == NULL)
+        {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    xQueueReset(loop_queue);
+    xSemaphoreTake(loop_slot, 0);
+    xSemaphoreGive(loop_slot);                                                          //++ First finger can be captured right away
+    memset(&loop_stats, 0, sizeof(loop_stats));
+
+    loop_running = 1;
+    if(xTaskCreate(r307_loop_task, "r307_loop",
+                   loop_config.task_stack_size ? loop_config.task_stack_size : R307_LOOP_STACK_SIZE,
+                   NULL,
+                   loop_config.task_priority ? loop_config.task_priority : R307_LOOP_PRIORITY,
+                   &loop_task_handle) != pdPASS)
+    {
+        loop_running = 0;
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(R307_LOOP, "Identify loop started, polling every %lu ms", (unsigned long)loop_config.poll_ms);
+    return ESP_OK;
+}
+
+esp_err_t r307_loop_stop(void)
+{
+    if(loop_task_handle == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    loop_running = 0;
+    xSemaphoreGive(loop_slot);                                                          //++ Wake the loop task so it can exit
+    xSemaphoreTake(loop_exited, portMAX_DELAY);                                         //++ Waits for an identify in progress, then r307_loop_start can follow at once
+    loop_task_handle = NULL;
+    xQueueReset(loop_queue);
+
+    return ESP_OK;
+}
+
+esp_err_t r307_loop_next(r307_identify_result_t *result, uint32_t timeout_ms)
+{
+    r307_loop_item_t item;
+
+    if(loop_queue == NULL || !loop_running)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    loop_consumer_waiting = 1;
+    const BaseType_t received = xQueueReceive(loop_queue, &item, pdMS_TO_TICKS(timeout_ms));
+    loop_consumer_waiting = 0;
+    if(received != pdTRUE)
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    memcpy(result, &item.result, sizeof(*result));
+    loop_stats.results++;
+    loop_stats.total_ready_us += esp_timer_get_time() - item.ready_us;
+    xSemaphoreGive(loop_slot);                                                          //++ Loop starts on the next finger while the application handles this one
+
+    return ESP_OK;
+}
+
+void r307_loop_get_stats(r307_loop_stats_t *stats)
+{
+    memcpy(stats, &loop_stats, sizeof(*stats));
+}
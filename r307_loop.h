@@ -0,0 +1,74 @@
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#include "r307_flow.h"
+
+#ifndef r307_loop_H
+#define r307_loop_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief CONFIGURATION OF THE IDENTIFY LOOP
+ */
+typedef struct
+{
+    char r307_address[4];                   //++ Module Address used by the identify flow
+    uint16_t library_size;                  //++ Number of pages searched by the identify flow
+    uint32_t poll_ms;                       //++ Pause between two GenImg while no finger is on the sensor ( 0 : Default )
+    uint32_t task_stack_size;               //++ Stack size of the loop task ( 0 : Default )
+    unsigned int task_priority;             //++ Priority of the loop task ( 0 : Default )
+} r307_loop_config_t;
+
+/**
+ * @brief THROUGHPUT OF THE IDENTIFY LOOP
+ */
+typedef struct
+{
+    uint32_t results;                       //++ Identify results handed to the application
+    uint32_t speculative;                   //++ Results captured while the application was still busy with the previous one
+    uint32_t empty_polls;                   //++ GenImg answered No Finger ( 0x02 ) while waiting for a finger
+    uint32_t lift_polls;                    //++ GenImg sent while waiting for the previous finger to be lifted
+    int64_t total_ready_us;                 //++ Sum of the time results were ready before r307_loop_next asked for them
+} r307_loop_stats_t;
+
+/**
+ * @brief FUNCTION TO START THE LOOP TASK, WHICH KEEPS CAPTURING & IDENTIFYING FINGERS AHEAD OF THE APPLICATION
+ *
+ * @param config MODULE ADDRESS, IDENTIFY PARAMETERS & TASK SETTINGS
+ * @return RETURNS ESP_OK, ESP_ERR_INVALID_STATE IF ALREADY RUNNING, ESP_ERR_NO_MEM IF THE TASK OR QUEUE COULD NOT BE CREATED
+ */
+esp_err_t r307_loop_start(const r307_loop_config_t *config);
+
+/**
+ * @brief FUNCTION TO STOP THE LOOP TASK, A RESULT STILL PENDING IS DISCARDED
+ *
+ * @return RETURNS ESP_OK ONCE THE TASK HAS EXITED, ESP_ERR_INVALID_STATE IF NOT RUNNING
+ */
+esp_err_t r307_loop_stop(void);
+
+/**
+ * @brief FUNCTION TO TAKE THE NEXT IDENTIFY RESULT, THE LOOP STARTS ON THE FOLLOWING FINGER AS SOON AS IT IS TAKEN
+ *
+ * @param result FILLED WITH THE RESULT OF THE NEXT FINGER
+ * @param timeout_ms TIME TO WAIT FOR A FINGER
+ * @return RETURNS ESP_OK, ESP_ERR_TIMEOUT IF NO FINGER WAS IDENTIFIED IN TIME, ESP_ERR_INVALID_STATE IF NOT RUNNING
+ */
+esp_err_t r307_loop_next(r307_identify_result_t *result, uint32_t timeout_ms);
+
+/**
+ * @brief FUNCTION TO GET THE THROUGHPUT STATISTICS OF THE LOOP
+ *
+ * @param stats FILLED WITH THE STATISTICS
+ * @return
+ */
+void r307_loop_get_stats(r307_loop_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // r307_loop_H
@@ -0,0 +1,266 @@
+#include <stdint.h>
+#include "string.h"
+
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+
+#include "r307.h"
+#include "r307_notepad.h"
+
+#define R307_NOTEPAD_MAGIC_0 ('N')              //++ Header : 'N' 'K' Version Reserved CRC32 ( big endian )
+#define R307_NOTEPAD_MAGIC_1 ('K')
+#define R307_NOTEPAD_VERSION (2)                //++ 2 : CRC32 in the header, 1 : 4 byte header without one
+#define R307_NOTEPAD_HEADER_SIZE (8)
+#define R307_NOTEPAD_V1_HEADER_SIZE (4)
+
+static const char *R307_NOTEPAD = "R307_NOTEPAD";   //++ Notepad TAG
+
+static void r307_notepad_format(r307_notepad_t *notepad)
+{
+    memset(notepad->image, 0, sizeof(notepad->image));
+    notepad->image[0] = R307_NOTEPAD_MAGIC_0;
+    notepad->image[1] = R307_NOTEPAD_MAGIC_1;
+    notepad->image[2] = R307_NOTEPAD_VERSION;
+    notepad->used = R307_NOTEPAD_HEADER_SIZE;
+}
+
+static int r307_notepad_entry_size(const uint8_t entry[])
+{
+    return 2 + entry[0] + entry[1];                                                     //++ Key Length, Value Length, Key, Value
+}
+
+static int r307_notepad_find(const r307_notepad_t *notepad, const char *key)
+{
+    const int key_length = strlen(key);
+
+    for(int offset=R307_NOTEPAD_HEADER_SIZE; offset<notepad->used; offset+=r307_notepad_entry_size(&notepad->image[offset]))
+    {
+        if(notepad->image[offset] == key_length && memcmp(&notepad->image[offset + 2], key, key_length) == 0)
+        {
+            return offset;
+        }
+    }
+
+    return -1;
+}
+
+static uint32_t r307_notepad_crc(const r307_notepad_t *notepad)
+{
+    return esp_rom_crc32_le(0, &notepad->image[R307_NOTEPAD_HEADER_SIZE], R307_NOTEPAD_SIZE - R307_NOTEPAD_HEADER_SIZE);  //++ Bytes past used are always zero, so this covers the used bytes
+}
+
+static uint32_t r307_notepad_header_crc(const r307_notepad_t *notepad)
+{
+    const uint8_t *header = notepad->image;
+
+    return ((uint32_t)header[4] << 24) | ((uint32_t)header[5] << 16) | ((uint32_t)header[6] << 8) | header[7];
+}
+
+static uint16_t r307_notepad_walk(const r307_notepad_t *notepad)
+{
+    int offset = R307_NOTEPAD_HEADER_SIZE;
+
+    while(offset + 2 <= R307_NOTEPAD_SIZE)                                              //++ Entries end at a zero or erased key length
+    {
+        const uint8_t key_length = notepad->image[offset];
+
+        if(key_length == 0 || key_length > R307_NOTEPAD_MAX_KEY || offset + r307_notepad_entry_size(&notepad->image[offset]) > R307_NOTEPAD_SIZE)
+        {
+            break;
+        }
+        offset += r307_notepad_entry_size(&notepad->image[offset]);
+    }
+
+    return offset;
+}
+
+uint8_t r307_notepad_load(r307_notepad_t *notepad, char r307_address[])
+{
+    uint8_t confirmation_code = 0x00;
+
+    memset(notepad, 0, sizeof(*notepad));
+    memcpy(notepad->r307_address, r307_address, 4);
+
+    r307_link_acquire();
+    for(int page=0; page<R307_NOTEPAD_PAGES && confirmation_code == 0x00; page++)
+    {
+        char page_number[1] = {page};
+
+        confirmation_code = ReadNotepad(notepad->r307_address, page_number);
+        notepad->page_reads++;
+        if(confirmation_code == 0x00 && r307_get_response()->received)
+        {
+            memcpy(&notepad->flushed[page * R307_NOTEPAD_PAGE_SIZE], r307_get_response()->notepad, R307_NOTEPAD_PAGE_SIZE);
+        }
+        else
+        {
+            confirmation_code = confirmation_code ? confirmation_code : 0x01;
+        }
+    }
+    r307_link_release();
+    if(confirmation_code != 0x00)
+    {
+        ESP_LOGE(R307_NOTEPAD, "Reading the notepad failed, code 0x%02X", confirmation_code);
+        return confirmation_code;
+    }
+
+    memcpy(notepad->image, notepad->flushed, sizeof(notepad->image));
+    if(notepad->image[0] != R307_NOTEPAD_MAGIC_0 || notepad->image[1] != R307_NOTEPAD_MAGIC_1 || (notepad->image[2] != R307_NOTEPAD_VERSION && notepad->image[2] != 1))
+    {
+        ESP_LOGW(R307_NOTEPAD, "Notepad not formatted, starting empty");
+        r307_notepad_format(notepad);                                                   //++ Module copy is only replaced on the next flush
+    }
+    else if(notepad->image[2] == 1)                                                     //++ Version 1 had no CRC, move its entries behind the larger header
+    {
+        memmove(&notepad->image[R307_NOTEPAD_HEADER_SIZE], &notepad->image[R307_NOTEPAD_V1_HEADER_SIZE], R307_NOTEPAD_SIZE - R307_NOTEPAD_HEADER_SIZE);
+        notepad->image[2] = R307_NOTEPAD_VERSION;
+        notepad->used = r307_notepad_walk(notepad);                                     //++ A last entry that no longer fits is dropped
+        memset(&notepad->image[notepad->used], 0, R307_NOTEPAD_SIZE - notepad->used);
+        ESP_LOGW(R307_NOTEPAD, "Notepad version 1 converted, written on the next flush");
+    }
+    else if(r307_notepad_header_crc(notepad) != r307_notepad_crc(notepad))
+    {
+        ESP_LOGE(R307_NOTEPAD, "Notepad failed its CRC, interrupted flush or corruption, starting empty");
+        r307_notepad_format(notepad);
+    }
+    else
+    {
+        notepad->used = r307_notepad_walk(notepad);
+    }
+    notepad->loaded = 1;
+
+    return 0x00;
+}
+
+int r307_notepad_get(r307_notepad_t *notepad, const char *key, void *value, int max_length)
+{
+    const int offset = notepad->loaded ? r307_notepad_find(notepad, key) : -1;
+
+    if(offset < 0)
+    {
+        return -1;
+    }
+
+    const uint8_t *entry = &notepad->image[offset];
+    memcpy(value, &entry[2 + entry[0]], (entry[1] < max_length) ? entry[1] : max_length);
+    notepad->cached_reads++;
+
+    return entry[1];
+}
+
+esp_err_t r307_notepad_erase(r307_notepad_t *notepad, const char *key)
+{
+    const int offset = notepad->loaded ? r307_notepad_find(notepad, key) : -1;
+
+    if(offset < 0)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    const int size = r307_notepad_entry_size(&notepad->image[offset]);
+    memmove(&notepad->image[offset], &notepad->image[offset + size], notepad->used - offset - size);
+    notepad->used -= size;
+    memset(&notepad->image[notepad->used], 0, R307_NOTEPAD_SIZE - notepad->used);     //++ Zero key length ends the entries
+
+    return ESP_OK;
+}
+
+esp_err_t r307_notepad_set(r307_notepad_t *notepad, const char *key, const void *value, int length)
+{
+    const int key_length = strlen(key);
+    const int offset = notepad->loaded ? r307_notepad_find(notepad, key) : -1;
+    const int old_size = (offset < 0) ? 0 : r307_notepad_entry_size(&notepad->image[offset]);
+
+    if(!notepad->loaded || key_length == 0 || key_length > R307_NOTEPAD_MAX_KEY || length < 0 || length > 255)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if(notepad->used - old_size + 2 + key_length + length > R307_NOTEPAD_SIZE)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    if(offset >= 0)
+    {
+        if(notepad->image[offset + 1] == length && memcmp(&notepad->image[offset + 2 + key_length], value, length) == 0)
+        {
+            return ESP_OK;                                                              //++ Same value, keep the page clean
+        }
+        r307_notepad_erase(notepad, key);
+    }
+
+    uint8_t *entry = &notepad->image[notepad->used];
+    entry[0] = key_length;
+    entry[1] = length;
+    memcpy(&entry[2], key, key_length);
+    memcpy(&entry[2 + key_length], value, length);
+    notepad->used += 2 + key_length + length;
+
+    return ESP_OK;
+}
+
+esp_err_t r307_notepad_get_u32(r307_notepad_t *notepad, const char *key, uint32_t *value)
+{
+    uint8_t bytes[4];
+
+    if(r307_notepad_get(notepad, key, bytes, sizeof(bytes)) != sizeof(bytes))
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+    *value = ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) | ((uint32_t)bytes[2] << 8) | bytes[3];
+
+    return ESP_OK;
+}
+
+esp_err_t r307_notepad_set_u32(r307_notepad_t *notepad, const char *key, uint32_t value)
+{
+    const uint8_t bytes[4] = {value >> 24, value >> 16, value >> 8, value};
+
+    return r307_notepad_set(notepad, key, bytes, sizeof(bytes));
+}
+
+uint8_t r307_notepad_flush(r307_notepad_t *notepad)
+{
+    uint8_t confirmation_code = 0x00;
+    int written = 0;
+
+    if(!notepad->loaded)
+    {
+        return 0x01;
+    }
+
+    const uint32_t crc = r307_notepad_crc(notepad);
+    notepad->image[3] = 0;
+    notepad->image[4] = crc >> 24;
+    notepad->image[5] = crc >> 16;
+    notepad->image[6] = crc >> 8;
+    notepad->image[7] = crc;
+
+    r307_link_acquire();
+    for(int i=1; i<=R307_NOTEPAD_PAGES && confirmation_code == 0x00; i++)
+    {
+        const int page = i % R307_NOTEPAD_PAGES;                                        //++ Page 0 holds the header & goes last, a torn flush fails the CRC on load
+        const int offset = page * R307_NOTEPAD_PAGE_SIZE;
+        char page_number[1] = {page};
+
+        if(memcmp(&notepad->image[offset], &notepad->flushed[offset], R307_NOTEPAD_PAGE_SIZE) == 0)
+        {
+            continue;                                                                   //++ Module already holds this page
+        }
+        confirmation_code = WriteNotepad(notepad->r307_address, page_number, (const char *)&notepad->image[offset]);
+        notepad->page_writes++;
+        if(confirmation_code == 0x00 && r307_get_response()->received)
+        {
+            memcpy(&notepad->flushed[offset], &notepad->image[offset], R307_NOTEPAD_PAGE_SIZE);
+            written++;
+        }
+        else
+        {
+            confirmation_code = confirmation_code ? confirmation_code : 0x01;
+        }
+    }
+    r307_link_release();
+
+    ESP_LOGI(R307_NOTEPAD, "Flushed %d notepad pages, code 0x%02X", written, confirmation_code);
+
+    return confirmation_code;
+}
@@ -0,0 +1,104 @@
+#include <stdint.h>
+#include "esp_err.h"
+
+#include "r307.h"
+
+#ifndef r307_notepad_H
+#define r307_notepad_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define R307_NOTEPAD_SIZE (R307_NOTEPAD_PAGES * R307_NOTEPAD_PAGE_SIZE)    //++ Bytes of the whole notepad
+#define R307_NOTEPAD_MAX_KEY (15)               //++ Longest key in bytes
+
+/**
+ * @brief KEY-VALUE STORE KEPT IN THE MODULE'S NOTEPAD, WITH A WRITE-BACK COPY ON THE ESP32
+ */
+typedef struct
+{
+    char r307_address[4];                                       //++ Current Module Address
+    uint8_t loaded;                                             //++ 1 : image holds the notepad contents
+    uint16_t used;                                              //++ Bytes of image in use ( header & entries )
+    uint8_t image[R307_NOTEPAD_SIZE];                           //++ Notepad as the application sees it
+    uint8_t flushed[R307_NOTEPAD_SIZE];                         //++ Notepad as the module holds it
+    uint32_t page_reads;                                        //++ ReadNotepad commands sent
+    uint32_t page_writes;                                       //++ WriteNotepad commands sent
+    uint32_t cached_reads;                                      //++ Lookups answered without touching the module
+} r307_notepad_t;
+
+/**
+ * @brief FUNCTION TO READ THE WHOLE NOTEPAD ONCE ( E.G. AT BOOT ), AN UNFORMATTED NOTEPAD OR ONE FAILING ITS CRC STARTS EMPTY
+ *
+ * @param notepad KEY-VALUE STORE
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @return RETURNS 0x00 ON SUCCESS, ELSE CONFIRMATION CODE OF THE FAILED ReadNotepad ( R307_TIMEOUT IF UNANSWERED )
+ */
+uint8_t r307_notepad_load(r307_notepad_t *notepad, char r307_address[]);
+
+/**
+ * @brief FUNCTION TO LOOK UP A KEY IN THE CACHED NOTEPAD
+ *
+ * @param notepad KEY-VALUE STORE ( LOADED )
+ * @param key NUL TERMINATED KEY
+ * @param value FILLED WITH THE VALUE ( TRUNCATED TO max_length )
+ * @param max_length SIZE OF value
+ * @return RETURNS LENGTH OF THE VALUE, -1 IF THE KEY IS NOT PRESENT
+ */
+int r307_notepad_get(r307_notepad_t *notepad, const char *key, void *value, int max_length);
+
+/**
+ * @brief FUNCTION TO SET A KEY IN THE CACHED NOTEPAD, WRITTEN TO THE MODULE BY r307_notepad_flush
+ *
+ * @param notepad KEY-VALUE STORE ( LOADED )
+ * @param key NUL TERMINATED KEY ( 1 .. R307_NOTEPAD_MAX_KEY BYTES )
+ * @param value VALUE BYTES
+ * @param length LENGTH OF THE VALUE ( 0 .. 255 )
+ * @return RETURNS ESP_OK, ESP_ERR_INVALID_ARG FOR A BAD KEY OR LENGTH, ESP_ERR_NO_MEM IF THE NOTEPAD IS FULL
+ */
+esp_err_t r307_notepad_set(r307_notepad_t *notepad, const char *key, const void *value, int length);
+
+/**
+ * @brief FUNCTION TO REMOVE A KEY FROM THE CACHED NOTEPAD
+ *
+ * @param notepad KEY-VALUE STORE ( LOADED )
+ * @param key NUL TERMINATED KEY
+ * @return RETURNS ESP_OK, ESP_ERR_NOT_FOUND IF THE KEY IS NOT PRESENT
+ */
+esp_err_t r307_notepad_erase(r307_notepad_t *notepad, const char *key);
+
+/**
+ * @brief FUNCTION TO READ A 32-BIT VALUE ( SYNC GENERATION, LIBRARY VERSION, ... )
+ *
+ * @param notepad KEY-VALUE STORE ( LOADED )
+ * @param key NUL TERMINATED KEY
+ * @param value FILLED WITH THE VALUE
+ * @return RETURNS ESP_OK, ESP_ERR_NOT_FOUND IF THE KEY IS NOT PRESENT OR NOT 4 BYTES
+ */
+esp_err_t r307_notepad_get_u32(r307_notepad_t *notepad, const char *key, uint32_t *value);
+
+/**
+ * @brief FUNCTION TO SET A 32-BIT VALUE
+ *
+ * @param notepad KEY-VALUE STORE ( LOADED )
+ * @param key NUL TERMINATED KEY
+ * @param value VALUE
+ * @return RETURNS ESP_OK OR THE ERROR OF r307_notepad_set
+ */
+esp_err_t r307_notepad_set_u32(r307_notepad_t *notepad, const char *key, uint32_t value);
+
+/**
+ * @brief FUNCTION TO WRITE EVERY CHANGED NOTEPAD PAGE TO THE MODULE, UNCHANGED PAGES ARE NOT WRITTEN
+ *        PAGE 0 HOLDS THE HEADER WITH THE CRC OF THE ENTRIES AND IS WRITTEN LAST, SO AN INTERRUPTED FLUSH IS NEVER LOADED AS VALID
+ *
+ * @param notepad KEY-VALUE STORE ( LOADED )
+ * @return RETURNS 0x00 ON SUCCESS, ELSE CONFIRMATION CODE OF THE FAILED WriteNotepad ( R307_TIMEOUT IF UNANSWERED )
+ */
+uint8_t r307_notepad_flush(r307_notepad_t *notepad);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // r307_notepad_H
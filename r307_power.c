@@ -0,0 +1,158 @@
+#include <stdint.h>
+#include "string.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_sleep.h"
+
+#include "driver/gpio.h"
+
+#include "r307.h"
+#include "r307_power.h"
+
+#define R307_POWER_READY_TIMEOUT_MS (1000)      //++ Default max wait for the power-on byte
+#define R307_POWER_READY_BYTE (0x55)            //++ Byte sent by the module once it finished its power-on init
+
+static const char *R307_POWER = "R307_POWER";   //++ Power TAG
+
+static r307_power_config_t power_config;        //++ Active power configuration
+static r307_power_stats_t power_stats;          //++ Wake-to-ready statistics
+static uint8_t power_ready;                     //++ 1 while the sensor is powered & handshaked
+
+esp_err_t r307_power_init(const r307_power_config_t *config)
+{
+    if(config == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memcpy(&power_config, config, sizeof(power_config));
+    memset(&power_stats, 0, sizeof(power_stats));
+    if(power_config.ready_timeout_ms == 0)
+    {
+        power_config.ready_timeout_ms = R307_POWER_READY_TIMEOUT_MS;
+    }
+
+    const gpio_config_t io_config =
+    {
+        .pin_bit_mask = 1ULL << power_config.power_pin,
+        .mode = GPIO_MODE_OUTPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE,
+    };
+    esp_err_t err = gpio_config(&io_config);
+    if(err != ESP_OK)
+    {
+        return err;
+    }
+
+    gpio_set_level(power_config.power_pin, power_config.power_on_level);               //++ Sensor starts powered, r307_init is left to the application
+    power_ready = 1;
+
+    return ESP_OK;
+}
+
+esp_err_t r307_power_down(void)
+{
+    esp_err_t err = ESP_OK;
+
+    r307_link_acquire();                                                                //++ No other task may be waiting on the UART queue being deleted
+    r307_deinit();                                                                      //++ Release UART first so TX does not back-power the module
+    power_ready = 0;
+    err = gpio_set_level(power_config.power_pin, !power_config.power_on_level);
+    r307_link_release();
+
+    return err;
+}
+
+esp_err_t r307_power_sleep(uint32_t timeout_ms)
+{
+    esp_err_t err = ESP_OK;
+
+    if(timeout_ms == 0 && power_config.wakeup_pin < 0)
+    {
+        return ESP_ERR_INVALID_ARG;                                                     //++ No wake-up source, light-sleep would never return
+    }
+    if(power_ready)
+    {
+        r307_power_down();
+    }
+
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
+    if(power_config.wakeup_pin >= 0)
+    {
+        gpio_wakeup_enable(power_config.wakeup_pin, power_config.wakeup_level ? GPIO_INTR_HIGH_LEVEL : GPIO_INTR_LOW_LEVEL);
+        esp_sleep_enable_gpio_wakeup();
+    }
+    if(timeout_ms > 0)
+    {
+        esp_sleep_enable_timer_wakeup((uint64_t)timeout_ms * 1000);
+    }
+
+    gpio_hold_en(power_config.power_pin);                                               //++ Keep the sensor unpowered while sleeping
+    err = esp_light_sleep_start();
+    gpio_hold_dis(power_config.power_pin);
+
+    if(power_config.wakeup_pin >= 0)
+    {
+        gpio_wakeup_disable(power_config.wakeup_pin);
+    }
+
+    ESP_LOGI(R307_POWER, "Woke up from light-sleep, cause %d", esp_sleep_get_wakeup_cause());
+    return err;
+}
+
+uint8_t r307_power_resume(void)
+{
+    uint8_t confirmation_code = 0;
+
+    r307_link_acquire();                                                                //++ Reinstall, power-on & handshake must not meet another task's command
+    r307_init();                                                                        //++ Install UART before powering so the 0x55 byte is not missed
+
+    const int64_t start_time = esp_timer_get_time();
+    gpio_set_level(power_config.power_pin, power_config.power_on_level);
+
+    r307_wait_for_byte(R307_POWER_READY_BYTE, power_config.ready_timeout_ms);           //++ Return as soon as the module reports ready instead of a fixed settle delay
+    const int64_t boot_time = esp_timer_get_time();
+
+    r307_flush_input();
+    confirmation_code = VfyPwd(power_config.r307_address, power_config.r307_password);  //++ Single round trip restores the handshake
+    confirmation_code = (confirmation_code == 0x00 && !r307_get_response()->received) ? 0x01 : confirmation_code;
+    r307_link_release();
+    const int64_t ready_time = esp_timer_get_time();
+
+    power_stats.last_boot_us = boot_time - start_time;
+    if(confirmation_code != 0x00)
+    {
+        power_stats.resume_failures++;
+        ESP_LOGE(R307_POWER, "Handshake after wake failed with code 0x%02X", confirmation_code);
+        return confirmation_code ? confirmation_code : 0x01;
+    }
+
+    power_ready = 1;
+    power_stats.last_ready_us = ready_time - start_time;
+    if(power_stats.resume_count == 0 || power_stats.last_ready_us < power_stats.min_ready_us)
+    {
+        power_stats.min_ready_us = power_stats.last_ready_us;
+    }
+    if(power_stats.last_ready_us > power_stats.max_ready_us)
+    {
+        power_stats.max_ready_us = power_stats.last_ready_us;
+    }
+    power_stats.total_ready_us += power_stats.last_ready_us;
+    power_stats.resume_count++;
+
+    ESP_LOGI(R307_POWER, "Sensor ready in %lld us ( boot %lld us )", (long long)power_stats.last_ready_us, (long long)power_stats.last_boot_us);
+    return confirmation_code;
+}
+
+uint8_t r307_power_is_ready(void)
+{
+    return power_ready;
+}
+
+void r307_power_get_stats(r307_power_stats_t *stats)
+{
+    memcpy(stats, &power_stats, sizeof(*stats));
+}
@@ -0,0 +1,89 @@
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#ifndef r307_power_H
+#define r307_power_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief CONFIGURATION OF THE SENSOR POWER MANAGER
+ */
+typedef struct
+{
+    int power_pin;                          //++ ESP32 GPIO driving the switch on Pin 1 ( VIN ) of the sensor
+    int power_on_level;                     //++ Level of power_pin that powers the sensor
+    int wakeup_pin;                         //++ GPIO that wakes the ESP32 from light-sleep, e.g. Touch Output ( -1 : None )
+    int wakeup_level;                       //++ Level of wakeup_pin that wakes the ESP32
+    uint32_t ready_timeout_ms;              //++ Max wait for the 0x55 power-on byte before handshaking anyway ( 0 : Default )
+    char r307_address[4];                   //++ Module Address used to handshake after wake
+    char r307_password[4];                  //++ Module Password used to handshake after wake
+} r307_power_config_t;
+
+/**
+ * @brief WAKE-TO-READY LATENCY MEASURED BY THE POWER MANAGER
+ */
+typedef struct
+{
+    uint32_t resume_count;                  //++ Number of successful resumes
+    uint32_t resume_failures;               //++ Number of resumes where the handshake failed
+    int64_t last_boot_us;                   //++ Power ON to 0x55 byte ( or its timeout ) of the last resume
+    int64_t last_ready_us;                  //++ Power ON to handshake complete of the last resume
+    int64_t min_ready_us;                   //++ Fastest wake-to-ready latency
+    int64_t max_ready_us;                   //++ Slowest wake-to-ready latency
+    int64_t total_ready_us;                 //++ Sum of all wake-to-ready latencies ( divide by resume_count for average )
+} r307_power_stats_t;
+
+/**
+ * @brief FUNCTION TO CONFIGURE THE POWER GPIO & POWER THE SENSOR ON
+ *
+ * @param config POWER PIN, WAKE-UP PIN & HANDSHAKE CREDENTIALS
+ * @return RETURNS ESP_OK ON SUCCESS
+ */
+esp_err_t r307_power_init(const r307_power_config_t *config);
+
+/**
+ * @brief FUNCTION TO RELEASE THE UART & CUT SENSOR POWER
+ *
+ * @return RETURNS ESP_OK ON SUCCESS
+ */
+esp_err_t r307_power_down(void);
+
+/**
+ * @brief FUNCTION TO CUT SENSOR POWER & PUT THE ESP32 IN LIGHT-SLEEP UNTIL WAKE-UP PIN OR TIMEOUT
+ *
+ * @param timeout_ms MAXIMUM SLEEP TIME ( 0 : SLEEP UNTIL WAKE-UP PIN )
+ * @return RETURNS ESP_OK ON SUCCESS, ESP_ERR_INVALID_ARG IF timeout_ms IS 0 WITHOUT A WAKE-UP PIN ( SENSOR STAYS POWERED )
+ */
+esp_err_t r307_power_sleep(uint32_t timeout_ms);
+
+/**
+ * @brief FUNCTION TO POWER THE SENSOR ON & RESTORE UART, BAUD & HANDSHAKE
+ *
+ * @return RETURNS RECEIVED CONFIRMATION CODE OF THE HANDSHAKE ( VfyPwd )
+ */
+uint8_t r307_power_resume(void);
+
+/**
+ * @brief FUNCTION TO CHECK WHETHER THE SENSOR IS POWERED & READY
+ *
+ * @return RETURNS 1 IF READY, 0 OTHERWISE
+ */
+uint8_t r307_power_is_ready(void);
+
+/**
+ * @brief FUNCTION TO READ THE MEASURED WAKE-TO-READY LATENCY
+ *
+ * @param stats FILLED WITH THE CURRENT STATISTICS
+ * @return
+ */
+void r307_power_get_stats(r307_power_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // r307_power_H
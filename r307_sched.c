@@ -0,0 +1,254 @@
+#include <stdint.h>
+#include "string.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include "r307.h"
+#include "r307_sched.h"
+
+static const char *R307_SCHED = "R307_SCHED";   //++ Scheduler TAG
+
+typedef struct
+{
+    uint8_t in_use;
+    TaskHandle_t task;
+    r307_sched_class_t sched_class;
+    int64_t enqueue_us;                         //++ Time the task started waiting
+    SemaphoreHandle_t wake;                     //++ Given when the link is handed to the task
+} r307_sched_waiter_t;
+
+typedef struct
+{
+    TaskHandle_t task;
+    r307_sched_class_t sched_class;
+} r307_sched_task_t;
+
+static SemaphoreHandle_t sched_lock;            //++ Protects everything below
+static r307_sched_config_t sched_config;
+static r307_sched_waiter_t sched_waiters[R307_SCHED_MAX_WAITERS];
+static r307_sched_task_t sched_tasks[R307_SCHED_MAX_TASKS];
+static r307_sched_stats_t sched_stats[R307_SCHED_CLASSES];
+static TaskHandle_t sched_owner;                //++ Task owning the link, NULL if free
+static int sched_depth;                         //++ Nested acquires of the owner
+static int64_t sched_last_background_us;        //++ Last grant to the background class
+
+static r307_sched_class_t r307_sched_class_of(TaskHandle_t task)
+{
+    for(int i=0; i<R307_SCHED_MAX_TASKS; i++)
+    {
+        if(sched_tasks[i].task == task)
+        {
+            return sched_tasks[i].sched_class;
+        }
+    }
+
+    return sched_config.default_class;
+}
+
+static void r307_sched_grant(TaskHandle_t task, r307_sched_class_t sched_class, int64_t wait_us)
+{
+    r307_sched_stats_t *stats = &sched_stats[sched_class];
+
+    sched_owner = task;
+    sched_depth = 1;
+    stats->grants++;
+    if(wait_us > 0)
+    {
+        stats->waits++;
+        stats->total_wait_us += wait_us;
+        stats->max_wait_us = (wait_us > stats->max_wait_us) ? wait_us : stats->max_wait_us;
+    }
+    if(sched_class == R307_SCHED_BACKGROUND)
+    {
+        sched_last_background_us = esp_timer_get_time();
+    }
+}
+
+static int r307_sched_effective_class(const r307_sched_waiter_t *waiter, int64_t now)
+{
+    int effective_class = waiter->sched_class;
+
+    if(sched_config.aging_ms)                                                           //++ Long waits climb classes, so admin & background can't starve
+    {
+        effective_class += (now - waiter->enqueue_us) / ((int64_t)sched_config.aging_ms * 1000);
+    }
+
+    return effective_class;
+}
+
+static void r307_sched_acquire(void)
+{
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    r307_sched_waiter_t *waiter = NULL;
+
+    xSemaphoreTake(sched_lock, portMAX_DELAY);
+    if(sched_owner == task)
+    {
+        sched_depth++;
+        xSemaphoreGive(sched_lock);
+        return;
+    }
+
+    const r307_sched_class_t sched_class = r307_sched_class_of(task);
+    if(sched_class == R307_SCHED_BACKGROUND && sched_config.background_gap_ms)
+    {
+        const int64_t wait_us = sched_last_background_us + (int64_t)sched_config.background_gap_ms * 1000 - esp_timer_get_time();
+
+        if(wait_us > 0)                                                                 //++ Rate limit background traffic before it even queues
+        {
+            xSemaphoreGive(sched_lock);
+            vTaskDelay(pdMS_TO_TICKS(wait_us / 1000) + 1);
+            xSemaphoreTake(sched_lock, portMAX_DELAY);
+        }
+    }
+
+    while(sched_owner != NULL && waiter == NULL)
+    {
+        for(int i=0; i<R307_SCHED_MAX_WAITERS && waiter == NULL; i++)
+        {
+            if(!sched_waiters[i].in_use)
+            {
+                waiter = &sched_waiters[i];
+            }
+        }
+        if(waiter == NULL)                                                              //++ All slots taken, retry shortly
+        {
+            xSemaphoreGive(sched_lock);
+            vTaskDelay(1);
+            xSemaphoreTake(sched_lock, portMAX_DELAY);
+        }
+    }
+
+    if(sched_owner == NULL)
+    {
+        r307_sched_grant(task, sched_class, 0);
+        xSemaphoreGive(sched_lock);
+        return;
+    }
+
+    waiter->in_use = 1;
+    waiter->task = task;
+    waiter->sched_class = sched_class;
+    waiter->enqueue_us = esp_timer_get_time();
+    xSemaphoreGive(sched_lock);
+
+    xSemaphoreTake(waiter->wake, portMAX_DELAY);                                        //++ r307_sched_release hands the link over directly
+}
+
+static void r307_sched_release(void)
+{
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    r307_sched_waiter_t *next = NULL;
+    const int64_t now = esp_timer_get_time();
+
+    xSemaphoreTake(sched_lock, portMAX_DELAY);
+    if(sched_owner != task || --sched_depth > 0)
+    {
+        xSemaphoreGive(sched_lock);
+        return;
+    }
+
+    for(int i=0; i<R307_SCHED_MAX_WAITERS; i++)                                         //++ Highest effective class first, oldest first within a class
+    {
+        r307_sched_waiter_t *waiter = &sched_waiters[i];
+
+        if(!waiter->in_use)
+        {
+            continue;
+        }
+        if(next == NULL || r307_sched_effective_class(waiter, now) > r307_sched_effective_class(next, now) || (r307_sched_effective_class(waiter, now) == r307_sched_effective_class(next, now) && waiter->enqueue_us < next->enqueue_us))
+        {
+            next = waiter;
+        }
+    }
+
+    if(next == NULL)
+    {
+        sched_owner = NULL;
+        sched_depth = 0;
+        xSemaphoreGive(sched_lock);
+        return;
+    }
+
+    for(int i=0; i<R307_SCHED_MAX_WAITERS; i++)
+    {
+        if(sched_waiters[i].in_use && &sched_waiters[i] != next && sched_waiters[i].enqueue_us < next->enqueue_us)
+        {
+            sched_stats[sched_waiters[i].sched_class].overtaken++;                      //++ Was waiting longer but lost to a higher class
+        }
+    }
+    r307_sched_grant(next->task, next->sched_class, now - next->enqueue_us);
+    next->in_use = 0;
+    xSemaphoreGive(next->wake);
+    xSemaphoreGive(sched_lock);
+}
+
+esp_err_t r307_sched_init(const r307_sched_config_t *config)
+{
+    if(sched_lock == NULL)
+    {
+        sched_lock = xSemaphoreCreateMutex();
+        for(int i=0; i<R307_SCHED_MAX_WAITERS && sched_lock; i++)
+        {
+            sched_waiters[i].wake = xSemaphoreCreateBinary();
+            if(sched_waiters[i].wake == NULL)
+            {
+                return ESP_ERR_NO_MEM;
+            }
+        }
+        if(sched_lock == NULL)
+        {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    memcpy(&sched_config, config, sizeof(sched_config));
+    memset(sched_stats, 0, sizeof(sched_stats));
+    r307_set_link_hooks(r307_sched_acquire, r307_sched_release);
+    ESP_LOGI(R307_SCHED, "Scheduler owns the link, aging %lu ms", (unsigned long)sched_config.aging_ms);
+
+    return ESP_OK;
+}
+
+esp_err_t r307_sched_set_task_class(TaskHandle_t task, r307_sched_class_t sched_class)
+{
+    r307_sched_task_t *entry = NULL;
+
+    if(sched_lock == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    task = task ? task : xTaskGetCurrentTaskHandle();
+    xSemaphoreTake(sched_lock, portMAX_DELAY);
+    for(int i=0; i<R307_SCHED_MAX_TASKS; i++)                                           //++ Existing entry of the task, else the first free one
+    {
+        if(sched_tasks[i].task == task || (entry == NULL && sched_tasks[i].task == NULL))
+        {
+            entry = &sched_tasks[i];
+        }
+        if(sched_tasks[i].task == task)
+        {
+            break;
+        }
+    }
+    if(entry)
+    {
+        entry->task = task;
+        entry->sched_class = sched_class;
+    }
+    xSemaphoreGive(sched_lock);
+
+    return entry ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+void r307_sched_get_stats(r307_sched_class_t sched_class, r307_sched_stats_t *stats)
+{
+    xSemaphoreTake(sched_lock, portMAX_DELAY);
+    memcpy(stats, &sched_stats[sched_class], sizeof(*stats));
+    xSemaphoreGive(sched_lock);
+}
@@ -0,0 +1,79 @@
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifndef r307_sched_H
+#define r307_sched_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define R307_SCHED_MAX_WAITERS (8)              //++ Tasks that can wait for the link at the same time
+#define R307_SCHED_MAX_TASKS (8)                //++ Tasks that can be given a class with r307_sched_set_task_class
+
+/**
+ * @brief PRIORITY CLASS OF A TASK USING THE MODULE, HIGHER CLASSES GET THE LINK FIRST
+ */
+typedef enum
+{
+    R307_SCHED_BACKGROUND = 0,              //++ Health checks, library sync, backup ( rate limited )
+    R307_SCHED_ADMIN,                       //++ Enrollment & library management
+    R307_SCHED_LIVE,                        //++ Identify / verify of a waiting user
+    R307_SCHED_CLASSES,
+} r307_sched_class_t;
+
+/**
+ * @brief SCHEDULER SETTINGS
+ */
+typedef struct
+{
+    r307_sched_class_t default_class;       //++ Class of tasks not registered with r307_sched_set_task_class
+    uint32_t aging_ms;                      //++ A waiter gains one class for every aging_ms it waits ( 0 : No aging )
+    uint32_t background_gap_ms;             //++ Minimum time between two link grants of the background class
+} r307_sched_config_t;
+
+/**
+ * @brief QUEUE WAIT TIME OF ONE PRIORITY CLASS
+ */
+typedef struct
+{
+    uint32_t grants;                        //++ Times the link was granted ( nested acquires not counted )
+    uint32_t waits;                         //++ Grants that had to queue behind another task
+    int64_t total_wait_us;                  //++ Sum of queue wait time
+    int64_t max_wait_us;                    //++ Longest queue wait time
+    uint32_t overtaken;                     //++ Times a higher class was served while this class waited
+} r307_sched_stats_t;
+
+/**
+ * @brief FUNCTION TO START THE SCHEDULER & HOOK IT INTO THE DRIVER SO EVERY COMMAND WAITS FOR THE LINK
+ *
+ * @param config SCHEDULER SETTINGS
+ * @return RETURNS ESP_OK, ESP_ERR_NO_MEM IF ITS SEMAPHORES COULD NOT BE CREATED
+ */
+esp_err_t r307_sched_init(const r307_sched_config_t *config);
+
+/**
+ * @brief FUNCTION TO SET THE PRIORITY CLASS OF A TASK
+ *
+ * @param task TASK HANDLE ( NULL : CALLING TASK )
+ * @param sched_class CLASS OF ALL COMMANDS SENT BY THE TASK
+ * @return RETURNS ESP_OK, ESP_ERR_NO_MEM IF R307_SCHED_MAX_TASKS TASKS ARE ALREADY REGISTERED, ESP_ERR_INVALID_STATE BEFORE r307_sched_init
+ */
+esp_err_t r307_sched_set_task_class(TaskHandle_t task, r307_sched_class_t sched_class);
+
+/**
+ * @brief FUNCTION TO GET THE QUEUE WAIT STATISTICS OF A CLASS
+ *
+ * @param sched_class PRIORITY CLASS
+ * @param stats FILLED WITH THE STATISTICS
+ * @return
+ */
+void r307_sched_get_stats(r307_sched_class_t sched_class, r307_sched_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // r307_sched_H
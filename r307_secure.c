@@ -0,0 +1,363 @@
+#include <stdint.h>
+#include "string.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_system.h"
+#include "mbedtls/aes.h"
+#include "mbedtls/sha256.h"
+
+#include "r307.h"
+#include "r307_secure.h"
+
+#define R307_SECURE_CHUNK_SIZE (64)             //++ Bytes decrypted at a time while downloading
+#define R307_SECURE_HMAC_BLOCK (64)             //++ SHA-256 block size, the HMAC key is padded to it
+
+static const char *R307_SECURE = "R307_SECURE"; //++ Secure TAG
+
+typedef struct
+{
+    r307_secure_stream_t stream;
+    uint8_t *output;                            //++ Encrypted template being filled
+    int fill;                                   //++ Template bytes received so far
+} r307_secure_upload_t;
+
+static uint8_t secure_plain[R307_TEMPLATE_SIZE];  //++ Plain template of the bench
+static r307_secure_template_t secure_bench_template;
+
+static void r307_secure_wipe(void *data, size_t length)
+{
+    volatile uint8_t *bytes = data;                                                     //++ Not optimized away like a memset before the end of scope
+
+    while(length--)
+    {
+        *bytes++ = 0;
+    }
+}
+
+static void r307_secure_hmac_key(const r307_secure_t *secure, uint8_t pad, uint8_t block[R307_SECURE_HMAC_BLOCK])
+{
+    memset(block, pad, R307_SECURE_HMAC_BLOCK);
+    for(int i=0; i<(int)sizeof(secure->mac_key); i++)
+    {
+        block[i] ^= secure->mac_key[i];
+    }
+}
+
+void r307_secure_stream_begin(r307_secure_stream_t *stream, r307_secure_t *secure, const uint8_t nonce[R307_SECURE_NONCE_SIZE])
+{
+    uint8_t block[R307_SECURE_HMAC_BLOCK];
+
+    memset(stream, 0, sizeof(*stream));
+    stream->secure = secure;
+    memcpy(stream->counter, nonce, R307_SECURE_NONCE_SIZE);
+
+    r307_secure_hmac_key(secure, 0x36, block);                                          //++ Inner hash : key ^ ipad, then the nonce, then the encrypted bytes
+    mbedtls_sha256_init(&stream->mac);
+    mbedtls_sha256_starts_ret(&stream->mac, 0);
+    mbedtls_sha256_update_ret(&stream->mac, block, sizeof(block));
+    mbedtls_sha256_update_ret(&stream->mac, nonce, R307_SECURE_NONCE_SIZE);
+    r307_secure_wipe(block, sizeof(block));
+}
+
+static void r307_secure_stream_tag(r307_secure_stream_t *stream, uint8_t tag[R307_SECURE_TAG_SIZE])
+{
+    uint8_t block[R307_SECURE_HMAC_BLOCK];
+    uint8_t hash[32];
+    mbedtls_sha256_context outer;
+
+    mbedtls_sha256_finish_ret(&stream->mac, hash);
+    r307_secure_hmac_key(stream->secure, 0x5C, block);                                  //++ Outer hash : key ^ opad, then the inner hash
+    mbedtls_sha256_init(&outer);
+    mbedtls_sha256_starts_ret(&outer, 0);
+    mbedtls_sha256_update_ret(&outer, block, sizeof(block));
+    mbedtls_sha256_update_ret(&outer, hash, sizeof(hash));
+    mbedtls_sha256_finish_ret(&outer, hash);
+    mbedtls_sha256_free(&outer);
+    memcpy(tag, hash, R307_SECURE_TAG_SIZE);
+    r307_secure_wipe(block, sizeof(block));
+    r307_secure_wipe(stream, sizeof(*stream));
+}
+
+static uint8_t r307_secure_tag_equal(const uint8_t a[R307_SECURE_TAG_SIZE], const uint8_t b[R307_SECURE_TAG_SIZE])
+{
+    uint8_t difference = 0;
+
+    for(int i=0; i<R307_SECURE_TAG_SIZE; i++)                                           //++ Constant time, the position of the first difference is not leaked
+    {
+        difference |= a[i] ^ b[i];
+    }
+
+    return difference == 0;
+}
+
+static void r307_secure_crypt(r307_secure_stream_t *stream, const uint8_t input[], uint8_t output[], int length)
+{
+    mbedtls_aes_crypt_ctr(&stream->secure->aes, length, &stream->stream_offset, stream->counter, stream->stream_block, input, output);
+}
+
+void r307_secure_seal_begin(r307_secure_stream_t *stream, r307_secure_t *secure, uint8_t nonce[R307_SECURE_NONCE_SIZE])
+{
+    esp_fill_random(nonce, R307_SECURE_NONCE_SIZE);                                     //++ Fresh counter block, a key stream is never reused
+    r307_secure_stream_begin(stream, secure, nonce);
+}
+
+void r307_secure_seal(r307_secure_stream_t *stream, const uint8_t plain[], uint8_t encrypted[], int length)
+{
+    r307_secure_crypt(stream, plain, encrypted, length);
+    mbedtls_sha256_update_ret(&stream->mac, encrypted, length);                         //++ Encrypt-then-MAC
+}
+
+void r307_secure_seal_end(r307_secure_stream_t *stream, uint8_t tag[R307_SECURE_TAG_SIZE])
+{
+    r307_secure_stream_tag(stream, tag);
+}
+
+static int r307_secure_encrypt_package(const uint8_t data[], int length, void *arg)
+{
+    r307_secure_upload_t *upload = arg;
+
+    if(upload->fill + length > R307_TEMPLATE_SIZE)
+    {
+        return 1;                                                                       //++ Longer than any template, abort the transfer
+    }
+
+    r307_secure_seal(&upload->stream, data, &upload->output[upload->fill], length);
+    upload->fill += length;
+
+    return 0;
+}
+
+esp_err_t r307_secure_init(r307_secure_t *secure, const uint8_t key[R307_SECURE_KEY_SIZE])
+{
+    uint8_t label[16] = {0};
+
+    memset(secure, 0, sizeof(*secure));
+    mbedtls_aes_init(&secure->aes);
+    if(mbedtls_aes_setkey_enc(&secure->aes, key, R307_SECURE_KEY_SIZE * 8) != 0)       //++ CTR only ever runs the block cipher forward
+    {
+        mbedtls_aes_free(&secure->aes);
+        return ESP_ERR_INVALID_ARG;
+    }
+    for(int i=0; i<2; i++)                                                              //++ MAC key = AES(1) || AES(2), never the AES key itself
+    {
+        label[15] = i + 1;
+        mbedtls_aes_crypt_ecb(&secure->aes, MBEDTLS_AES_ENCRYPT, label, &secure->mac_key[i * 16]);
+    }
+
+    return ESP_OK;
+}
+
+void r307_secure_free(r307_secure_t *secure)
+{
+    mbedtls_aes_free(&secure->aes);
+    r307_secure_wipe(secure, sizeof(*secure));
+}
+
+void r307_secure_set_password(r307_secure_t *secure, const char r307_password[])
+{
+    r307_secure_stream_t stream;
+
+    r307_secure_seal_begin(&stream, secure, secure->password_nonce);
+    r307_secure_crypt(&stream, (const uint8_t *)r307_password, secure->sealed_password, 4);
+    r307_secure_wipe(&stream, sizeof(stream));
+    secure->password_set = 1;
+}
+
+static void r307_secure_unseal_password(r307_secure_t *secure, char r307_password[])
+{
+    r307_secure_stream_t stream;
+
+    r307_secure_stream_begin(&stream, secure, secure->password_nonce);
+    r307_secure_crypt(&stream, secure->sealed_password, (uint8_t *)r307_password, 4);
+    r307_secure_wipe(&stream, sizeof(stream));
+}
+
+uint8_t r307_secure_verify(r307_secure_t *secure, char r307_address[])
+{
+    char r307_password[4];
+    uint8_t confirmation_code = 0;
+
+    if(!secure->password_set)
+    {
+        return 0x13;                                                                    //++ Same as the module's WRONG PASSWORD
+    }
+
+    r307_secure_unseal_password(secure, r307_password);
+    confirmation_code = VfyPwd(r307_address, r307_password);
+    r307_secure_wipe(r307_password, sizeof(r307_password));
+
+    return confirmation_code;
+}
+
+uint8_t r307_secure_change_password(r307_secure_t *secure, char r307_address[], const char new_password[])
+{
+    char r307_password[4];
+    uint8_t confirmation_code = 0;
+
+    memcpy(r307_password, new_password, sizeof(r307_password));                        //++ SetPwd takes a non-const buffer
+    confirmation_code = SetPwd(r307_address, r307_password);
+    r307_secure_wipe(r307_password, sizeof(r307_password));
+    if(confirmation_code == 0x00 && r307_get_response()->received)
+    {
+        r307_secure_set_password(secure, new_password);
+    }
+
+    return confirmation_code;
+}
+
+uint8_t r307_secure_up_char(r307_secure_t *secure, char r307_address[], char buffer_id[], r307_secure_template_t *encrypted)
+{
+    r307_secure_upload_t upload;
+    uint8_t confirmation_code = 0;
+
+    memset(encrypted, 0, sizeof(*encrypted));
+    r307_secure_seal_begin(&upload.stream, secure, encrypted->nonce);
+    upload.output = encrypted->data;
+    upload.fill = 0;
+
+    confirmation_code = r307_up_char(r307_address, buffer_id, r307_secure_encrypt_package, &upload);
+    if(confirmation_code == 0x00)
+    {
+        encrypted->length = upload.fill;
+        r307_secure_seal_end(&upload.stream, encrypted->tag);
+    }
+    r307_secure_wipe(&upload, sizeof(upload));
+
+    return confirmation_code;
+}
+
+uint8_t r307_secure_down_data(r307_secure_t *secure, char r307_address[], char buffer_id[], const uint8_t nonce[R307_SECURE_NONCE_SIZE], const uint8_t data[], int length, const uint8_t tag[R307_SECURE_TAG_SIZE])
+{
+    r307_secure_stream_t stream;
+    r307_data_writer_t writer;
+    uint8_t chunk[R307_SECURE_CHUNK_SIZE];
+    uint8_t expected_tag[R307_SECURE_TAG_SIZE];
+    uint8_t confirmation_code = 0;
+
+    if(length < 0 || length > R307_TEMPLATE_SIZE)
+    {
+        return R307_SECURE_BAD_CHECK;
+    }
+
+    r307_secure_stream_begin(&stream, secure, nonce);                                   //++ Authenticate first, nothing unverified reaches the module
+    mbedtls_sha256_update_ret(&stream.mac, data, length);
+    r307_secure_stream_tag(&stream, expected_tag);
+    if(!r307_secure_tag_equal(expected_tag, tag))
+    {
+        ESP_LOGE(R307_SECURE, "Template failed authentication, wrong key, corrupted or tampered");
+        return R307_SECURE_BAD_CHECK;
+    }
+
+    r307_secure_stream_begin(&stream, secure, nonce);
+    r307_link_acquire();                                                                //++ Acknowledge & Data Packages form one exchange
+    confirmation_code = r307_down_char_begin(r307_address, buffer_id, &writer, length);
+    for(int offset=0; confirmation_code == 0x00 && r307_get_response()->received && offset<length; offset+=sizeof(chunk))
+    {
+        const int chunk_length = (length - offset < (int)sizeof(chunk)) ? length - offset : (int)sizeof(chunk);
+
+        r307_secure_crypt(&stream, &data[offset], chunk, chunk_length);                 //++ Decrypted just before it goes out, the writer sends full packages
+        confirmation_code = r307_data_writer_write(chunk, chunk_length, &writer) == 0 ? 0x00 : 0x01;
+        if(confirmation_code != 0x00)
+        {
+            r307_data_writer_pad(&writer);                                              //++ Module still waits for End of Data, don't leave it mid-transfer
+            r307_invalidate_char_buffers();
+        }
+    }
+    r307_link_release();
+
+    r307_secure_wipe(chunk, sizeof(chunk));
+    r307_secure_wipe(&writer, sizeof(writer));                                          //++ Its package buffer held the last plain chunk
+    r307_secure_wipe(&stream, sizeof(stream));
+
+    return confirmation_code;
+}
+
+uint8_t r307_secure_down_char(r307_secure_t *secure, char r307_address[], char buffer_id[], const r307_secure_template_t *encrypted)
+{
+    return r307_secure_down_data(secure, r307_address, buffer_id, encrypted->nonce, encrypted->data, encrypted->length, encrypted->tag);
+}
+
+static int r307_secure_copy_plain(const uint8_t data[], int length, void *arg)
+{
+    int *fill = arg;
+
+    if(*fill + length > R307_TEMPLATE_SIZE)
+    {
+        return 1;
+    }
+    memcpy(&secure_plain[*fill], data, length);
+    *fill += length;
+
+    return 0;
+}
+
+uint8_t r307_secure_bench(r307_secure_t *secure, char r307_address[], char buffer_id[], uint16_t rounds, r307_secure_bench_t *bench)
+{
+    r307_secure_stream_t stream;
+    int64_t plain_up_us = 0;
+    int64_t secure_up_us = 0;
+    int64_t plain_down_us = 0;
+    int64_t secure_down_us = 0;
+    uint8_t confirmation_code = 0x00;
+    int fill = 0;
+
+    memset(bench, 0, sizeof(*bench));
+    r307_link_acquire();                                                                //++ Every round must move the same CharBuffer
+    for(int i=0; i<rounds && confirmation_code == 0x00; i++)
+    {
+        int64_t start_time = esp_timer_get_time();
+
+        fill = 0;
+        confirmation_code = r307_up_char(r307_address, buffer_id, r307_secure_copy_plain, &fill);
+        plain_up_us += esp_timer_get_time() - start_time;
+
+        if(confirmation_code == 0x00)
+        {
+            start_time = esp_timer_get_time();
+            confirmation_code = r307_down_char(r307_address, buffer_id, secure_plain, fill);
+            plain_down_us += esp_timer_get_time() - start_time;
+        }
+        if(confirmation_code == 0x00)
+        {
+            start_time = esp_timer_get_time();
+            confirmation_code = r307_secure_up_char(secure, r307_address, buffer_id, &secure_bench_template);
+            secure_up_us += esp_timer_get_time() - start_time;
+        }
+        if(confirmation_code == 0x00)
+        {
+            start_time = esp_timer_get_time();
+            confirmation_code = r307_secure_down_char(secure, r307_address, buffer_id, &secure_bench_template);
+            secure_down_us += esp_timer_get_time() - start_time;
+        }
+
+        bench->rounds += (confirmation_code == 0x00);
+        bench->failures += (confirmation_code != 0x00);
+    }
+    r307_link_release();
+
+    if(bench->rounds)
+    {
+        const int64_t start_time = esp_timer_get_time();
+
+        r307_secure_stream_begin(&stream, secure, secure_bench_template.nonce);
+        for(int i=0; i<bench->rounds; i++)                                              //++ Same bytes through AES alone, to split link from cipher time
+        {
+            r307_secure_crypt(&stream, secure_plain, secure_bench_template.data, fill);
+        }
+        const int64_t aes_us = esp_timer_get_time() - start_time;
+
+        bench->aes_bytes_per_second = aes_us ? (uint32_t)((int64_t)fill * bench->rounds * 1000000 / aes_us) : 0;
+        bench->plain_up_us = plain_up_us / bench->rounds;
+        bench->secure_up_us = secure_up_us / bench->rounds;
+        bench->plain_down_us = plain_down_us / bench->rounds;
+        bench->secure_down_us = secure_down_us / bench->rounds;
+        ESP_LOGI(R307_SECURE, "UpChar %lld / %lld us, DownChar %lld / %lld us ( plain / encrypted ), AES %lu bytes/s",
+                 (long long)bench->plain_up_us, (long long)bench->secure_up_us, (long long)bench->plain_down_us, (long long)bench->secure_down_us,
+                 (unsigned long)bench->aes_bytes_per_second);
+    }
+    r307_secure_wipe(secure_plain, sizeof(secure_plain));
+    r307_secure_wipe(&stream, sizeof(stream));
+
+    return confirmation_code;
+}
@@ -0,0 +1,207 @@
+#include <stdint.h>
+#include "esp_err.h"
+#include "mbedtls/aes.h"
+#include "mbedtls/sha256.h"
+
+#include "r307.h"
+
+#ifndef r307_secure_H
+#define r307_secure_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define R307_SECURE_KEY_SIZE (32)               //++ AES-256 key in bytes
+#define R307_SECURE_NONCE_SIZE (16)             //++ Initial AES-CTR counter block in bytes
+#define R307_SECURE_TAG_SIZE (16)               //++ HMAC-SHA256 of nonce & encrypted template, truncated
+#define R307_SECURE_BAD_CHECK (0xFE)            //++ Returned when a template fails authentication ( wrong key, corrupted or tampered, never sent by the module )
+
+/**
+ * @brief KEY & SEALED MODULE PASSWORD, NOTHING SECRET IS KEPT IN PLAIN TEXT
+ */
+typedef struct
+{
+    mbedtls_aes_context aes;                    //++ Expanded key ( ESP32 AES peripheral with CONFIG_MBEDTLS_HARDWARE_AES, software elsewhere )
+    uint8_t mac_key[32];                        //++ HMAC-SHA256 key, derived from the AES key
+    uint8_t password_nonce[R307_SECURE_NONCE_SIZE];   //++ Counter block the password was sealed with
+    uint8_t sealed_password[4];                 //++ Module Password, encrypted
+    uint8_t password_set;                       //++ 1 : sealed_password holds a password
+} r307_secure_t;
+
+/**
+ * @brief AES-CTR & HMAC STATE OF ONE TEMPLATE, CARRIED FROM ONE DATA PACKAGE TO THE NEXT ( E.G. INSIDE AN r307_up_char CALLBACK )
+ */
+typedef struct
+{
+    r307_secure_t *secure;
+    size_t stream_offset;                       //++ Position inside stream_block
+    uint8_t counter[R307_SECURE_NONCE_SIZE];
+    uint8_t stream_block[16];
+    mbedtls_sha256_context mac;                 //++ Inner HMAC hash over the nonce & the encrypted bytes so far
+} r307_secure_stream_t;
+
+/**
+ * @brief TEMPLATE ENCRYPTED WITH AES-CTR & AUTHENTICATED WITH HMAC-SHA256, SAFE TO KEEP IN RAM, FLASH OR SEND OVER THE NETWORK
+ */
+typedef struct
+{
+    uint8_t nonce[R307_SECURE_NONCE_SIZE];      //++ Random initial counter block of this template
+    uint16_t length;                            //++ Template bytes in data
+    uint16_t reserved;
+    uint8_t data[R307_TEMPLATE_SIZE];           //++ Encrypted template
+    uint8_t tag[R307_SECURE_TAG_SIZE];          //++ Authenticates nonce & data, checked before anything is decrypted
+} r307_secure_template_t;
+
+/**
+ * @brief TIME OF PLAIN & ENCRYPTED TEMPLATE TRANSFERS ON THE SAME CHARBUFFER
+ */
+typedef struct
+{
+    uint16_t rounds;                            //++ Rounds of each transfer completed
+    uint16_t failures;                          //++ Rounds that failed
+    int64_t plain_up_us;                        //++ Average UpChar into RAM
+    int64_t secure_up_us;                       //++ Average UpChar encrypted while the Data Packages arrive
+    int64_t plain_down_us;                      //++ Average DownChar from RAM
+    int64_t secure_down_us;                     //++ Average DownChar decrypted while the Data Packages are sent
+    uint32_t aes_bytes_per_second;              //++ AES-CTR throughput on a template in RAM, without the UART
+} r307_secure_bench_t;
+
+/**
+ * @brief FUNCTION TO LOAD THE KEY ( E.G. READ FROM ENCRYPTED NVS OR DERIVED FROM AN EFUSE KEY )
+ *
+ * @param secure CONTEXT TO INITIALIZE
+ * @param key AES-256 KEY, MAY BE WIPED BY THE CALLER AFTERWARDS
+ * @return RETURNS ESP_OK, ESP_ERR_INVALID_ARG IF THE KEY WAS REJECTED
+ */
+esp_err_t r307_secure_init(r307_secure_t *secure, const uint8_t key[R307_SECURE_KEY_SIZE]);
+
+/**
+ * @brief FUNCTION TO WIPE THE KEY & SEALED PASSWORD
+ *
+ * @param secure CONTEXT
+ * @return
+ */
+void r307_secure_free(r307_secure_t *secure);
+
+/**
+ * @brief FUNCTION TO SEAL THE MODULE PASSWORD, IT IS ONLY UNSEALED FOR A VfyPwd / SetPwd ( WHOSE COMMAND FRAME ON THE STACK & IN THE UART TX BUFFER IS NOT WIPED )
+ *
+ * @param secure CONTEXT
+ * @param r307_password MODULE PASSWORD, MAY BE WIPED BY THE CALLER AFTERWARDS
+ * @return
+ */
+void r307_secure_set_password(r307_secure_t *secure, const char r307_password[]);
+
+/**
+ * @brief FUNCTION TO HANDSHAKE WITH THE SEALED PASSWORD
+ *
+ * @param secure CONTEXT WITH A SEALED PASSWORD
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @return RETURNS RECEIVED CONFIRMATION CODE OF VfyPwd, 0x13 IF NO PASSWORD WAS SEALED
+ */
+uint8_t r307_secure_verify(r307_secure_t *secure, char r307_address[]);
+
+/**
+ * @brief FUNCTION TO CHANGE THE MODULE PASSWORD & SEAL THE NEW ONE
+ *
+ * @param secure CONTEXT
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @param new_password NEW MODULE PASSWORD, MAY BE WIPED BY THE CALLER AFTERWARDS
+ * @return RETURNS RECEIVED CONFIRMATION CODE OF SetPwd
+ */
+uint8_t r307_secure_change_password(r307_secure_t *secure, char r307_address[], const char new_password[]);
+
+/**
+ * @brief FUNCTION TO START ENCRYPTING ONE TEMPLATE WITH A FRESH RANDOM COUNTER BLOCK
+ *
+ * @param stream STATE TO INITIALIZE
+ * @param secure CONTEXT
+ * @param nonce FILLED WITH THE COUNTER BLOCK, STORE IT WITH THE ENCRYPTED TEMPLATE
+ * @return
+ */
+void r307_secure_seal_begin(r307_secure_stream_t *stream, r307_secure_t *secure, uint8_t nonce[R307_SECURE_NONCE_SIZE]);
+
+/**
+ * @brief FUNCTION TO RESTART THE KEY STREAM OF AN ENCRYPTED TEMPLATE ( E.G. TO ENCRYPT PLAIN BYTES & COMPARE THEM WITH IT )
+ *
+ * @param stream STATE TO INITIALIZE
+ * @param secure CONTEXT
+ * @param nonce COUNTER BLOCK STORED WITH THE ENCRYPTED TEMPLATE
+ * @return
+ */
+void r307_secure_stream_begin(r307_secure_stream_t *stream, r307_secure_t *secure, const uint8_t nonce[R307_SECURE_NONCE_SIZE]);
+
+/**
+ * @brief FUNCTION TO ENCRYPT THE NEXT BYTES OF A TEMPLATE ( E.G. ONE DATA PACKAGE OF UpChar )
+ *
+ * @param stream STATE FROM r307_secure_seal_begin OR r307_secure_stream_begin
+ * @param plain PLAIN BYTES
+ * @param encrypted FILLED WITH length ENCRYPTED BYTES
+ * @param length BYTES TO ENCRYPT
+ * @return
+ */
+void r307_secure_seal(r307_secure_stream_t *stream, const uint8_t plain[], uint8_t encrypted[], int length);
+
+/**
+ * @brief FUNCTION TO FINISH A TEMPLATE : COMPUTES THE TAG OVER THE NONCE & THE ENCRYPTED BYTES & WIPES THE STATE
+ *
+ * @param stream STATE FROM r307_secure_seal_begin OR r307_secure_stream_begin
+ * @param tag FILLED WITH THE TAG, STORE IT WITH THE ENCRYPTED TEMPLATE
+ * @return
+ */
+void r307_secure_seal_end(r307_secure_stream_t *stream, uint8_t tag[R307_SECURE_TAG_SIZE]);
+
+/**
+ * @brief FUNCTION TO UPLOAD A CHARBUFFER & ENCRYPT EVERY DATA PACKAGE AS IT ARRIVES, THE WHOLE PLAIN TEMPLATE IS NEVER ASSEMBLED IN RAM
+ *
+ * @param secure CONTEXT
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @param buffer_id BUFFER ID ( CHARACTER FILE BUFFER NUMBER )
+ * @param encrypted FILLED WITH THE ENCRYPTED TEMPLATE
+ * @return RETURNS RECEIVED CONFIRMATION CODE FROM MODULE, OR 0x01 IF THE TRANSFER BROKE
+ */
+uint8_t r307_secure_up_char(r307_secure_t *secure, char r307_address[], char buffer_id[], r307_secure_template_t *encrypted);
+
+/**
+ * @brief FUNCTION TO DOWNLOAD AN ENCRYPTED TEMPLATE TO A CHARBUFFER, DECRYPTING IT PACKAGE BY PACKAGE WHILE IT IS SENT
+ *
+ * @param secure CONTEXT
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @param buffer_id BUFFER ID ( CHARACTER FILE BUFFER NUMBER )
+ * @param encrypted TEMPLATE FROM r307_secure_up_char
+ * @return RETURNS RECEIVED CONFIRMATION CODE FROM MODULE, R307_SECURE_BAD_CHECK IF THE TEMPLATE FAILED AUTHENTICATION ( NOTHING IS SENT )
+ */
+uint8_t r307_secure_down_char(r307_secure_t *secure, char r307_address[], char buffer_id[], const r307_secure_template_t *encrypted);
+
+/**
+ * @brief FUNCTION TO DOWNLOAD A TEMPLATE ENCRYPTED WITH r307_secure_seal ( KEPT IN THE CALLER'S OWN LAYOUT, E.G. A BACKUP RECORD )
+ *
+ * @param secure CONTEXT
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @param buffer_id BUFFER ID ( CHARACTER FILE BUFFER NUMBER )
+ * @param nonce COUNTER BLOCK FROM r307_secure_seal_begin
+ * @param data ENCRYPTED TEMPLATE
+ * @param length BYTES IN data ( AT MOST R307_TEMPLATE_SIZE )
+ * @param tag TAG FROM r307_secure_seal_end
+ * @return RETURNS RECEIVED CONFIRMATION CODE FROM MODULE, R307_SECURE_BAD_CHECK IF THE TEMPLATE FAILED AUTHENTICATION ( NOTHING IS SENT )
+ */
+uint8_t r307_secure_down_data(r307_secure_t *secure, char r307_address[], char buffer_id[], const uint8_t nonce[R307_SECURE_NONCE_SIZE], const uint8_t data[], int length, const uint8_t tag[R307_SECURE_TAG_SIZE]);
+
+/**
+ * @brief FUNCTION TO TIME PLAIN AGAINST ENCRYPTED UpChar & DownChar OF ONE CHARBUFFER ( ITS CONTENTS ARE WRITTEN BACK UNCHANGED )
+ *
+ * @param secure CONTEXT
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @param buffer_id BUFFER ID HOLDING A TEMPLATE ( E.G. AFTER LoadChar )
+ * @param rounds TRANSFERS OF EACH KIND
+ * @param bench FILLED WITH AVERAGE TIMES & AES THROUGHPUT
+ * @return RETURNS 0x00, ELSE CONFIRMATION CODE OF THE FIRST FAILED TRANSFER
+ */
+uint8_t r307_secure_bench(r307_secure_t *secure, char r307_address[], char buffer_id[], uint16_t rounds, r307_secure_bench_t *bench);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // r307_secure_H
@@ -0,0 +1,314 @@
+#include <stdint.h>
+#include "string.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "r307.h"
+#include "r307_session.h"
+
+static const char *R307_SESSION = "R307_SESSION";   //++ Session TAG
+
+static void r307_session_check_link(r307_session_t *session)
+{
+    if(session->link_generation != r307_get_link_generation())                         //++ UART was reinstalled, the module may have been power cycled
+    {
+        r307_session_invalidate(session);
+        session->link_generation = r307_get_link_generation();
+    }
+    if(session->library_generation != r307_get_library_generation())                   //++ Library changed outside this session ( usermap, sync, restore, ... )
+    {
+        session->template_number_valid = 0;
+        session->library_generation = r307_get_library_generation();
+    }
+}
+
+void r307_session_init(r307_session_t *session, char r307_address[], char r307_password[])
+{
+    memset(session, 0, sizeof(*session));
+    memcpy(session->r307_address, r307_address, 4);
+    memcpy(session->r307_password, r307_password, 4);
+    session->link_generation = r307_get_link_generation();
+    session->library_generation = r307_get_library_generation();
+}
+
+void r307_session_invalidate(r307_session_t *session)
+{
+    session->verified = 0;
+    session->sys_para_valid = 0;
+    session->template_number_valid = 0;
+}
+
+void r307_session_invalidate_sys_para(r307_session_t *session)
+{
+    session->sys_para_valid = 0;
+}
+
+uint8_t r307_session_verify(r307_session_t *session)
+{
+    uint8_t confirmation_code = 0;
+
+    r307_session_check_link(session);
+    if(session->verified)
+    {
+        session->saved_round_trips++;
+        return 0x00;
+    }
+
+    r307_link_acquire();                                                                //++ Acknowledge must be read before another task's command replaces it
+    confirmation_code = VfyPwd(session->r307_address, session->r307_password);
+    session->verified = (confirmation_code == 0x00 && r307_get_response()->received);
+    r307_link_release();
+
+    return confirmation_code;
+}
+
+uint8_t r307_session_read_sys_para(r307_session_t *session)
+{
+    uint8_t confirmation_code = 0;
+
+    r307_session_check_link(session);
+    if(session->sys_para_valid)
+    {
+        session->saved_round_trips++;
+        return 0x00;
+    }
+
+    r307_link_acquire();
+    confirmation_code = ReadSysPara(session->r307_address);
+    if(confirmation_code == 0x00 && r307_get_response()->received)
+    {
+        const r307_response_t *response = r307_get_response();
+
+        session->status_register = response->status_register;
+        session->library_size = response->library_size;
+        session->security_level = response->security_level;
+        session->packet_size = 32 << (response->size_code & 0x03);                      //++ Size Code 0:32 1:64 2:128 3:256 Bytes
+        session->baud_rate = response->baud_n * 9600;
+        session->sys_para_valid = 1;
+        r307_set_packet_size(session->packet_size);                                     //++ Bulk transfers must use the module's size
+        ESP_LOGI(R307_SESSION, "Cached system parameters, library size %d", session->library_size);
+    }
+    r307_link_release();
+
+    return confirmation_code;
+}
+
+uint8_t r307_session_template_number(r307_session_t *session, uint16_t *template_number)
+{
+    uint8_t confirmation_code = 0;
+
+    r307_session_check_link(session);
+    if(session->template_number_valid)
+    {
+        session->saved_round_trips++;
+        *template_number = session->template_number;
+        return 0x00;
+    }
+
+    r307_link_acquire();
+    confirmation_code = TempleteNum(session->r307_address);
+    if(confirmation_code == 0x00 && r307_get_response()->received)
+    {
+        session->template_number = r307_get_response()->template_number;
+        session->template_number_valid = 1;
+        session->library_generation = r307_get_library_generation();
+    }
+    r307_link_release();
+    *template_number = session->template_number;
+
+    return confirmation_code;
+}
+
+uint8_t r307_session_set_pwd(r307_session_t *session, char new_password[])
+{
+    uint8_t confirmation_code = 0;
+
+    r307_link_acquire();
+    confirmation_code = SetPwd(session->r307_address, new_password);
+    session->verified = 0;                                                              //++ Next request handshakes with whichever password is now valid
+    if(confirmation_code == 0x00 && r307_get_response()->received)
+    {
+        memcpy(session->r307_password, new_password, 4);
+    }
+    r307_link_release();
+
+    return confirmation_code;
+}
+
+uint8_t r307_session_set_adder(r307_session_t *session, char new_address[])
+{
+    uint8_t confirmation_code = 0;
+
+    r307_link_acquire();
+    confirmation_code = SetAdder(session->r307_address, new_address);
+    session->verified = 0;
+    session->sys_para_valid = 0;                                                        //++ Address is part of the system parameters
+    if(confirmation_code == 0x00 && r307_get_response()->received)
+    {
+        memcpy(session->r307_address, new_address, 4);
+    }
+    r307_link_release();
+
+    return confirmation_code;
+}
+
+uint8_t r307_session_set_sys_para(r307_session_t *session, char parameter_number[], char content[])
+{
+    uint8_t confirmation_code = 0;
+    uint8_t received = 0;
+
+    r307_link_acquire();
+    confirmation_code = SetSysPara(session->r307_address, parameter_number, content);
+    received = r307_get_response()->received;
+    r307_link_release();
+    session->sys_para_valid = 0;
+    if(confirmation_code != 0x00 || !received)
+    {
+        return confirmation_code;
+    }
+
+    if(parameter_number[0] == R307_SYS_PARA_BAUD)                                       //++ Module acknowledges at the old baud, then switches
+    {
+        r307_set_baud_rate(content[0] * 9600);
+    }
+    else if(parameter_number[0] == R307_SYS_PARA_PACKET_SIZE)
+    {
+        r307_set_packet_size(32 << (content[0] & 0x03));
+    }
+
+    return confirmation_code;
+}
+
+uint8_t r307_session_negotiate_packet_size(r307_session_t *session, uint16_t packet_size)
+{
+    char parameter_number[1] = {R307_SYS_PARA_PACKET_SIZE};
+    char content[1] = {0};
+    uint8_t confirmation_code = r307_session_read_sys_para(session);
+
+    while(content[0] < 3 && (32 << content[0]) < packet_size)
+    {
+        content[0]++;                                                                   //++ Size Code 0:32 1:64 2:128 3:256 Bytes
+    }
+    if(confirmation_code != 0x00 || session->packet_size == (32 << content[0]))
+    {
+        return confirmation_code;
+    }
+
+    confirmation_code = r307_session_set_sys_para(session, parameter_number, content);
+    if(confirmation_code == 0x00)
+    {
+        confirmation_code = r307_session_read_sys_para(session);                        //++ Confirm, the driver follows whatever the module reports
+    }
+    if(confirmation_code == 0x00 && session->packet_size != (32 << content[0]))
+    {
+        confirmation_code = 0x1A;
+    }
+    ESP_LOGI(R307_SESSION, "Packet size %d bytes, code 0x%02X", session->packet_size, confirmation_code);
+
+    return confirmation_code;
+}
+
+static int r307_session_count_bytes(const uint8_t data[], int length, void *arg)
+{
+    *(uint32_t *)arg += length;
+    return 0;
+}
+
+uint8_t r307_session_bench_packet_sizes(r307_session_t *session, char page_id[], uint8_t rounds, r307_packet_size_bench_t results[4])
+{
+    char buffer_id[1] = {0x01};
+    uint16_t original_size = 0;
+    uint8_t confirmation_code = 0;
+
+    memset(results, 0, 4 * sizeof(results[0]));
+    r307_link_acquire();                                                                //++ CharBuffer1 & the packet size must not change under the bench
+
+    confirmation_code = r307_session_read_sys_para(session);
+    original_size = session->packet_size;
+    if(confirmation_code == 0x00)
+    {
+        confirmation_code = r307_load_char_cached(session->r307_address, buffer_id, page_id);
+    }
+
+    for(int size_code=0; confirmation_code == 0x00 && size_code<4; size_code++)
+    {
+        r307_packet_size_bench_t *result = &results[size_code];
+        uint32_t bytes = 0;
+        int64_t time_us = 0;
+
+        result->packet_size = 32 << size_code;
+        if(r307_session_negotiate_packet_size(session, result->packet_size) != 0x00)
+        {
+            result->failures++;
+            continue;
+        }
+        for(int i=0; i<rounds; i++)
+        {
+            const int64_t start_time = esp_timer_get_time();
+            uint32_t transfer_bytes = 0;
+
+            if(r307_up_char(session->r307_address, buffer_id, r307_session_count_bytes, &transfer_bytes) != 0x00)
+            {
+                result->failures++;
+                continue;
+            }
+            time_us += esp_timer_get_time() - start_time;
+            bytes += transfer_bytes;
+            result->transfers++;
+        }
+        result->bytes_per_second = time_us ? (uint32_t)((int64_t)bytes * 1000000 / time_us) : 0;
+        ESP_LOGI(R307_SESSION, "Packet size %d : %lu bytes/s, %d failures", result->packet_size, (unsigned long)result->bytes_per_second, result->failures);
+    }
+
+    if(original_size)
+    {
+        const uint8_t restore_code = r307_session_negotiate_packet_size(session, original_size);
+        confirmation_code = confirmation_code ? confirmation_code : restore_code;
+    }
+    r307_link_release();
+
+    return confirmation_code;
+}
+
+uint8_t r307_session_store(r307_session_t *session, char buffer_id[], char page_id[])
+{
+    uint8_t confirmation_code = 0;
+
+    r307_link_acquire();                                                                //++ No other task may refill the cache between invalidate & Store
+    session->template_number_valid = 0;                                                 //++ Page may or may not have been occupied before
+    confirmation_code = Store(session->r307_address, buffer_id, page_id);
+    r307_link_release();
+
+    return confirmation_code;
+}
+
+uint8_t r307_session_delet_char(r307_session_t *session, char page_id[], char number_of_templates[])
+{
+    uint8_t confirmation_code = 0;
+
+    r307_link_acquire();
+    session->template_number_valid = 0;
+    confirmation_code = DeletChar(session->r307_address, page_id, number_of_templates);
+    r307_link_release();
+
+    return confirmation_code;
+}
+
+uint8_t r307_session_empty(r307_session_t *session)
+{
+    uint8_t confirmation_code = 0;
+
+    r307_link_acquire();
+    confirmation_code = Empty(session->r307_address);
+    session->template_number_valid = 0;
+    if(confirmation_code == 0x00 && r307_get_response()->received)
+    {
+        session->template_number = 0;                                                   //++ Known without asking the module
+        session->template_number_valid = 1;
+        session->library_generation = r307_get_library_generation();
+    }
+    r307_link_release();
+
+    return confirmation_code;
+}
@@ -0,0 +1,173 @@
+#include <stdint.h>
+
+#ifndef r307_session_H
+#define r307_session_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief CACHED STATE OF ONE R307 FINGERPRINT MODULE
+ */
+typedef struct
+{
+    char r307_address[4];                   //++ Current Module Address
+    char r307_password[4];                  //++ Current Module Password
+    uint32_t link_generation;               //++ Link generation the cache was filled under
+    uint32_t library_generation;            //++ Library generation template_number was read under
+    uint8_t verified;                       //++ 1 : VfyPwd handshake done
+    uint8_t sys_para_valid;                 //++ 1 : Fields below read by ReadSysPara are valid
+    uint8_t template_number_valid;          //++ 1 : template_number is valid
+    uint16_t status_register;               //++ Status Register
+    uint16_t library_size;                  //++ Finger Library Size
+    uint16_t security_level;                //++ Security Level
+    uint16_t packet_size;                   //++ Data Packet Size in Bytes
+    uint32_t baud_rate;                     //++ Module Baud
+    uint16_t template_number;               //++ Valid Template Number
+    uint32_t saved_round_trips;             //++ Number of commands answered from the cache
+} r307_session_t;
+
+/**
+ * @brief MEASURED UPLOAD THROUGHPUT AT ONE DATA PACKET SIZE
+ */
+typedef struct
+{
+    uint16_t packet_size;                   //++ Data Packet Size in Bytes
+    uint16_t transfers;                     //++ UpChar transfers completed
+    uint16_t failures;                      //++ Transfers broken, or SetSysPara refused the size
+    uint32_t bytes_per_second;              //++ Template bytes per second, acknowledge & Data Packages included
+} r307_packet_size_bench_t;
+
+/**
+ * @brief FUNCTION TO INITIALIZE A SESSION WITH AN EMPTY CACHE
+ *
+ * @param session SESSION TO INITIALIZE
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @param r307_password CURRENT MODULE PASSWORD
+ * @return
+ */
+void r307_session_init(r307_session_t *session, char r307_address[], char r307_password[]);
+
+/**
+ * @brief FUNCTION TO DROP EVERYTHING CACHED IN THE SESSION ( E.G. AFTER A POWER CYCLE )
+ *
+ * @param session SESSION TO INVALIDATE
+ * @return
+ */
+void r307_session_invalidate(r307_session_t *session);
+
+/**
+ * @brief FUNCTION TO DROP THE CACHED SYSTEM PARAMETERS ( E.G. AFTER SetSysPara )
+ *
+ * @param session SESSION TO INVALIDATE
+ * @return
+ */
+void r307_session_invalidate_sys_para(r307_session_t *session);
+
+/**
+ * @brief FUNCTION TO HANDSHAKE WITH VfyPwd, SKIPPED IF ALREADY VERIFIED ON THE SAME LINK
+ *
+ * @param session CURRENT SESSION
+ * @return RETURNS RECEIVED ( OR CACHED ) CONFIRMATION CODE
+ */
+uint8_t r307_session_verify(r307_session_t *session);
+
+/**
+ * @brief FUNCTION TO READ SYSTEM PARAMETERS WITH ReadSysPara, SKIPPED IF ALREADY CACHED
+ *
+ * @param session CURRENT SESSION, FILLED WITH LIBRARY SIZE, SECURITY LEVEL, PACKET SIZE & BAUD ( THE DRIVER FOLLOWS THE PACKET SIZE )
+ * @return RETURNS RECEIVED ( OR CACHED ) CONFIRMATION CODE
+ */
+uint8_t r307_session_read_sys_para(r307_session_t *session);
+
+/**
+ * @brief FUNCTION TO READ VALID TEMPLATE NUMBER WITH TempleteNum, SKIPPED IF ALREADY CACHED
+ *
+ * @param session CURRENT SESSION
+ * @param template_number FILLED WITH THE VALID TEMPLATE NUMBER
+ * @return RETURNS RECEIVED ( OR CACHED ) CONFIRMATION CODE
+ */
+uint8_t r307_session_template_number(r307_session_t *session, uint16_t *template_number);
+
+/**
+ * @brief FUNCTION TO SET NEW MODULE PASSWORD & UPDATE THE SESSION
+ *
+ * @param session CURRENT SESSION
+ * @param new_password NEW PASSWORD TO BE SET
+ * @return RETURNS RECEIVED CONFIRMATION CODE FROM MODULE
+ */
+uint8_t r307_session_set_pwd(r307_session_t *session, char new_password[]);
+
+/**
+ * @brief FUNCTION TO SET NEW MODULE ADDRESS & UPDATE THE SESSION
+ *
+ * @param session CURRENT SESSION
+ * @param new_address NEW ADDRESS TO BE SET
+ * @return RETURNS RECEIVED CONFIRMATION CODE FROM MODULE
+ */
+uint8_t r307_session_set_adder(r307_session_t *session, char new_address[]);
+
+/**
+ * @brief FUNCTION TO SET ONE SYSTEM PARAMETER, INVALIDATE THE CACHED PARAMETERS & FOLLOW A NEW BAUD OR PACKET SIZE
+ *
+ * @param session CURRENT SESSION
+ * @param parameter_number R307_SYS_PARA_BAUD | R307_SYS_PARA_SECURITY | R307_SYS_PARA_PACKET_SIZE
+ * @param content NEW VALUE OF THE PARAMETER
+ * @return RETURNS RECEIVED CONFIRMATION CODE FROM MODULE
+ */
+uint8_t r307_session_set_sys_para(r307_session_t *session, char parameter_number[], char content[]);
+
+/**
+ * @brief FUNCTION TO SWITCH MODULE & DRIVER TO A DATA PACKET SIZE, SKIPPED IF THE MODULE ALREADY USES IT
+ *
+ * @param session CURRENT SESSION
+ * @param packet_size 32, 64, 128 OR 256 BYTES ( 256 : FEWEST PACKAGES PER TRANSFER )
+ * @return RETURNS 0x00 ONCE ReadSysPara CONFIRMS THE SIZE, ELSE CONFIRMATION CODE OF THE FAILED COMMAND
+ */
+uint8_t r307_session_negotiate_packet_size(r307_session_t *session, uint16_t packet_size);
+
+/**
+ * @brief FUNCTION TO MEASURE UpChar THROUGHPUT AT EVERY DATA PACKET SIZE, THEN RESTORE THE MODULE'S SIZE
+ *
+ * @param session CURRENT SESSION
+ * @param page_id PAGE OF A TEMPLATE TO UPLOAD ( LOADED INTO CHARBUFFER1 )
+ * @param rounds UpChar TRANSFERS PER PACKET SIZE
+ * @param results FILLED FOR 32, 64, 128 & 256 BYTES
+ * @return RETURNS 0x00, ELSE CONFIRMATION CODE OF THE FAILED LoadChar OR RESTORE
+ */
+uint8_t r307_session_bench_packet_sizes(r307_session_t *session, char page_id[], uint8_t rounds, r307_packet_size_bench_t results[4]);
+
+/**
+ * @brief FUNCTION TO STORE TEMPLATE & INVALIDATE THE CACHED TEMPLATE NUMBER
+ *
+ * @param session CURRENT SESSION
+ * @param buffer_id BUFFER ID ( CHARACTER FILE BUFFER NUMBER )
+ * @param page_id FLASH LOCATION OF THE TEMPLATE
+ * @return RETURNS RECEIVED CONFIRMATION CODE FROM MODULE
+ */
+uint8_t r307_session_store(r307_session_t *session, char buffer_id[], char page_id[]);
+
+/**
+ * @brief FUNCTION TO DELETE N TEMPLATES & INVALIDATE THE CACHED TEMPLATE NUMBER
+ *
+ * @param session CURRENT SESSION
+ * @param page_id FLASH LOCATION OF THE FIRST TEMPLATE
+ * @param number_of_templates N : NUMBER OF TEMPLATES TO BE DELETED
+ * @return RETURNS RECEIVED CONFIRMATION CODE FROM MODULE
+ */
+uint8_t r307_session_delet_char(r307_session_t *session, char page_id[], char number_of_templates[]);
+
+/**
+ * @brief FUNCTION TO DELETE ALL TEMPLATES & UPDATE THE CACHED TEMPLATE NUMBER
+ *
+ * @param session CURRENT SESSION
+ * @return RETURNS RECEIVED CONFIRMATION CODE FROM MODULE
+ */
+uint8_t r307_session_empty(r307_session_t *session);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // r307_session_H
@@ -0,0 +1,320 @@
+#include <stdint.h>
+#include "string.h"
+
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+
+#include "r307.h"
+#include "r307_library.h"
+#include "r307_sync.h"
+
+static const char *R307_SYNC = "R307_SYNC";     //++ Sync TAG
+
+static uint8_t sync_batch[R307_SYNC_BATCH][R307_TEMPLATE_SIZE];                         //++ Templates on their way from source to target
+
+typedef struct
+{
+    uint8_t *data;                              //++ NULL : only hash the template
+    int length;
+    uint32_t crc;
+} r307_sync_upload_t;
+
+static int r307_sync_bit(const uint8_t bits[], int page)
+{
+    return (bits[page / 8] >> (page % 8)) & 0x01;
+}
+
+static void r307_sync_set_bit(uint8_t bits[], int page, int value)
+{
+    if(value)
+    {
+        bits[page / 8] |= 1 << (page % 8);
+    }
+    else
+    {
+        bits[page / 8] &= ~(1 << (page % 8));
+    }
+}
+
+static void r307_sync_cache(r307_sync_library_t *library, int page, int occupied, uint32_t page_hash)
+{
+    r307_sync_set_bit(library->cached, page, 1);
+    r307_sync_set_bit(library->occupied, page, occupied);
+    library->page_hash[page] = occupied ? page_hash : 0;
+}
+
+static int r307_sync_receive(const uint8_t data[], int length, void *arg)
+{
+    r307_sync_upload_t *upload = arg;
+
+    if(upload->length + length > R307_TEMPLATE_SIZE)
+    {
+        return -1;
+    }
+    if(upload->data)
+    {
+        memcpy(&upload->data[upload->length], data, length);
+    }
+    upload->crc = esp_rom_crc32_le(upload->crc, data, length);                          //++ Hash while the Data Packages arrive
+    upload->length += length;
+
+    return 0;
+}
+
+static uart_port_t r307_sync_enter(const r307_sync_library_t *library)
+{
+    r307_link_acquire();                                                                //++ The selected port belongs to the link owner
+    return r307_select_port(library->uart_port);
+}
+
+static void r307_sync_leave(uart_port_t previous_port)
+{
+    r307_select_port(previous_port);                                                    //++ Restored before the next task gets the link
+    r307_link_release();
+}
+
+static uint8_t r307_sync_upload(r307_sync_library_t *library, int page, r307_sync_upload_t *upload)
+{
+    char buffer_id[1] = {0x01};
+    char page_id[2] = {page >> 8, page & 0xFF};
+    uint8_t confirmation_code = 0;
+
+    const uart_port_t previous_port = r307_sync_enter(library);                         //++ LoadChar & UpChar of one page must not be split by another task
+    confirmation_code = LoadChar(library->r307_address, buffer_id, page_id);
+    if(!r307_get_response()->received)
+    {
+        confirmation_code = 0x01;
+    }
+    else if(confirmation_code == 0x00)
+    {
+        confirmation_code = r307_up_char(library->r307_address, buffer_id, r307_sync_receive, upload);
+    }
+    r307_sync_leave(previous_port);
+
+    return confirmation_code;                                                           //++ 0x0C : No valid template on this page
+}
+
+static uint8_t r307_sync_flush(r307_sync_library_t *source, r307_sync_library_t *target, const uint16_t pages[], int count, r307_sync_stats_t *stats)
+{
+    char buffer_id[1] = {0x01};
+    r307_sync_upload_t uploads[R307_SYNC_BATCH];
+    uint8_t result = 0x00;
+
+    for(int i=0; i<count; i++)                                                          //++ Read the whole batch, then write it
+    {
+        uint8_t confirmation_code = 0;
+
+        memset(&uploads[i], 0, sizeof(uploads[i]));
+        uploads[i].data = sync_batch[i];
+        confirmation_code = r307_sync_upload(source, pages[i], &uploads[i]);
+        if(confirmation_code == 0x00)
+        {
+            r307_sync_cache(source, pages[i], 1, uploads[i].crc);
+            stats->transfer_bytes += uploads[i].length;
+        }
+        else
+        {
+            if(confirmation_code == 0x0C)                                               //++ Source page was emptied since the scan
+            {
+                r307_sync_cache(source, pages[i], 0, 0);
+            }
+            else
+            {
+                ESP_LOGW(R307_SYNC, "Page %d not read from source, code 0x%02X", pages[i], confirmation_code);
+                r307_sync_invalidate_page(source, pages[i]);
+                stats->failures++;
+                result = result ? result : confirmation_code;
+            }
+            uploads[i].length = 0;
+        }
+    }
+
+    for(int i=0; i<count; i++)
+    {
+        char page_id[2] = {pages[i] >> 8, pages[i] & 0xFF};
+        uint8_t confirmation_code = 0;
+        uart_port_t previous_port;
+
+        if(uploads[i].length == 0)
+        {
+            continue;
+        }
+        previous_port = r307_sync_enter(target);                                        //++ DownChar & Store of one page must not be split by another task
+        confirmation_code = r307_down_char(target->r307_address, buffer_id, uploads[i].data, uploads[i].length);
+        if(confirmation_code == 0x00)
+        {
+            confirmation_code = Store(target->r307_address, buffer_id, page_id);
+        }
+        confirmation_code = (confirmation_code == 0x00 && !r307_get_response()->received) ? 0x01 : confirmation_code;
+        r307_sync_leave(previous_port);
+        if(confirmation_code == 0x00)
+        {
+            r307_sync_cache(target, pages[i], 1, uploads[i].crc);                       //++ Target now holds the very bytes hashed above
+            stats->transferred++;
+            stats->transfer_bytes += uploads[i].length;
+        }
+        else
+        {
+            ESP_LOGW(R307_SYNC, "Page %d not written to target, code 0x%02X", pages[i], confirmation_code);
+            r307_sync_invalidate_page(target, pages[i]);
+            stats->failures++;
+            result = result ? result : (confirmation_code ? confirmation_code : 0x01);
+        }
+    }
+
+    return result;
+}
+
+void r307_sync_library_init(r307_sync_library_t *library, uart_port_t uart_port, char r307_address[], uint16_t library_size)
+{
+    memset(library, 0, sizeof(*library));
+    library->uart_port = uart_port;
+    memcpy(library->r307_address, r307_address, 4);
+    library->library_size = library_size > R307_SYNC_MAX_PAGES ? R307_SYNC_MAX_PAGES : library_size;
+}
+
+void r307_sync_invalidate_page(r307_sync_library_t *library, uint16_t page)
+{
+    if(page < R307_SYNC_MAX_PAGES)
+    {
+        r307_sync_set_bit(library->cached, page, 0);
+    }
+}
+
+void r307_sync_invalidate(r307_sync_library_t *library)
+{
+    memset(library->cached, 0, sizeof(library->cached));
+}
+
+uint8_t r307_sync_scan(r307_sync_library_t *library, r307_sync_stats_t *stats)
+{
+    uint8_t occupied[R307_SYNC_MAX_PAGES / 8];
+    uint8_t confirmation_code = 0x00;
+    int uncached = 0;
+
+    for(int page=0; page<library->library_size; page++)
+    {
+        uncached += !r307_sync_bit(library->cached, page);
+    }
+    if(uncached)                                                                        //++ Index table first, empty pages are then never loaded
+    {
+        const uart_port_t previous_port = r307_sync_enter(library);
+
+        confirmation_code = r307_library_scan(library->r307_address, library->library_size, occupied);
+        r307_sync_leave(previous_port);
+    }
+
+    for(int page=0; confirmation_code == 0x00 && uncached && page<library->library_size; page++)
+    {
+        r307_sync_upload_t upload = {0};
+
+        if(r307_sync_bit(library->cached, page))
+        {
+            continue;
+        }
+        if(!r307_sync_bit(occupied, page))
+        {
+            r307_sync_cache(library, page, 0, 0);
+            continue;
+        }
+        confirmation_code = r307_sync_upload(library, page, &upload);
+        if(confirmation_code == 0x0C)
+        {
+            r307_sync_cache(library, page, 0, 0);
+            confirmation_code = 0x00;
+        }
+        else if(confirmation_code == 0x00)
+        {
+            r307_sync_cache(library, page, 1, upload.crc);
+            if(stats)
+            {
+                stats->scan_bytes += upload.length;
+            }
+        }
+        else
+        {
+            ESP_LOGE(R307_SYNC, "Scan stopped at page %d, code 0x%02X", page, confirmation_code);
+            break;
+        }
+    }
+
+    return confirmation_code;
+}
+
+uint8_t r307_sync_run(r307_sync_library_t *source, r307_sync_library_t *target, uint8_t delete_extra, r307_sync_stats_t *stats)
+{
+    r307_sync_stats_t sync_stats = {0};
+    uint16_t pages[R307_SYNC_BATCH];
+    const int library_size = source->library_size < target->library_size ? source->library_size : target->library_size;
+    uint8_t confirmation_code = 0x00;
+    int count = 0;
+
+    confirmation_code = r307_sync_scan(source, &sync_stats);                            //++ Cached pages cost nothing, only new or invalidated ones are uploaded
+    if(confirmation_code == 0x00)
+    {
+        confirmation_code = r307_sync_scan(target, &sync_stats);
+    }
+
+    for(int page=0; confirmation_code == 0x00 && delete_extra && page<library_size; page++)
+    {
+        int run = 0;
+
+        while(page + run < library_size && r307_sync_bit(target->occupied, page + run) && !r307_sync_bit(source->occupied, page + run))
+        {
+            run++;                                                                      //++ Coalesce extra pages into one DeletChar range
+        }
+        if(run == 0)
+        {
+            continue;
+        }
+
+        char page_id[2] = {page >> 8, page & 0xFF};
+        char number_of_templates[2] = {run >> 8, run & 0xFF};
+        const uart_port_t previous_port = r307_sync_enter(target);
+        confirmation_code = DeletChar(target->r307_address, page_id, number_of_templates);
+        confirmation_code = (confirmation_code == 0x00 && !r307_get_response()->received) ? 0x01 : confirmation_code;
+        r307_sync_leave(previous_port);
+        if(confirmation_code == 0x00)
+        {
+            for(int i=0; i<run; i++)
+            {
+                r307_sync_cache(target, page + i, 0, 0);
+            }
+            sync_stats.deleted += run;
+            sync_stats.delete_commands++;
+        }
+        page += run;
+    }
+
+    for(int page=0; confirmation_code == 0x00 && page<library_size; page++)
+    {
+        sync_stats.compared++;
+        if(!r307_sync_bit(source->occupied, page))
+        {
+            continue;
+        }
+        sync_stats.full_copy_bytes += 2 * R307_TEMPLATE_SIZE;                           //++ A full copy uploads & downloads every template
+        if(r307_sync_bit(target->occupied, page) && target->page_hash[page] == source->page_hash[page])
+        {
+            continue;
+        }
+        pages[count++] = page;
+        if(count == R307_SYNC_BATCH)
+        {
+            confirmation_code = r307_sync_flush(source, target, pages, count, &sync_stats);
+            count = 0;
+        }
+    }
+    if(confirmation_code == 0x00 && count)
+    {
+        confirmation_code = r307_sync_flush(source, target, pages, count, &sync_stats);
+    }
+
+    ESP_LOGI(R307_SYNC, "Copied %d templates, deleted %d, moved %lu bytes instead of %lu", sync_stats.transferred, sync_stats.deleted, (unsigned long)sync_stats.transfer_bytes, (unsigned long)sync_stats.full_copy_bytes);
+    if(stats)
+    {
+        *stats = sync_stats;
+    }
+
+    return confirmation_code;
+}
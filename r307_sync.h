@@ -0,0 +1,96 @@
+#include <stdint.h>
+#include "driver/uart.h"
+
+#include "r307.h"
+
+#ifndef r307_sync_H
+#define r307_sync_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define R307_SYNC_MAX_PAGES (1000)              //++ Library pages tracked per module ( R307 capacity )
+#define R307_SYNC_BATCH (4)                     //++ Templates uploaded from the source before they are written to the target
+
+/**
+ * @brief HOST-SIDE VIEW OF ONE MODULE'S LIBRARY : OCCUPANCY & CONTENT HASH OF EVERY PAGE
+ */
+typedef struct
+{
+    uart_port_t uart_port;                                      //++ Port the module is installed on ( r307_init_port )
+    char r307_address[4];                                       //++ Current Module Address
+    uint16_t library_size;                                      //++ Pages to compare ( at most R307_SYNC_MAX_PAGES )
+    uint8_t cached[R307_SYNC_MAX_PAGES / 8];                    //++ Bit n set : occupied & page_hash of page n are known
+    uint8_t occupied[R307_SYNC_MAX_PAGES / 8];                  //++ Bit n set : page n holds a template
+    uint32_t page_hash[R307_SYNC_MAX_PAGES];                    //++ CRC32 of the template on page n
+} r307_sync_library_t;
+
+/**
+ * @brief COUNTERS OF THE LAST SYNCHRONIZATION
+ */
+typedef struct
+{
+    uint16_t compared;                                          //++ Pages compared
+    uint16_t transferred;                                       //++ Templates copied to the target
+    uint16_t deleted;                                           //++ Pages removed from the target
+    uint16_t delete_commands;                                   //++ DeletChar commands used for them
+    uint16_t failures;                                          //++ Pages that could not be copied
+    uint32_t scan_bytes;                                        //++ Template bytes uploaded to fill the hash caches
+    uint32_t transfer_bytes;                                    //++ Template bytes uploaded & downloaded by the transfers
+    uint32_t full_copy_bytes;                                   //++ Template bytes a full copy of the source would move
+} r307_sync_stats_t;
+
+/**
+ * @brief FUNCTION TO INITIALIZE THE LIBRARY VIEW OF A MODULE WITH AN EMPTY CACHE
+ *
+ * @param library LIBRARY VIEW TO INITIALIZE
+ * @param uart_port PORT THE MODULE IS INSTALLED ON
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @param library_size PAGES TO COMPARE
+ * @return
+ */
+void r307_sync_library_init(r307_sync_library_t *library, uart_port_t uart_port, char r307_address[], uint16_t library_size);
+
+/**
+ * @brief FUNCTION TO DROP THE CACHED HASH OF ONE PAGE ( AFTER Store OR DeletChar OUTSIDE THE SYNC ENGINE )
+ *
+ * @param library LIBRARY VIEW
+ * @param page PAGE TO FORGET
+ * @return
+ */
+void r307_sync_invalidate_page(r307_sync_library_t *library, uint16_t page);
+
+/**
+ * @brief FUNCTION TO DROP EVERY CACHED HASH ( AFTER Empty OR A SENSOR SWAP )
+ *
+ * @param library LIBRARY VIEW
+ * @return
+ */
+void r307_sync_invalidate(r307_sync_library_t *library);
+
+/**
+ * @brief FUNCTION TO HASH EVERY PAGE NOT CACHED YET WITH LoadChar + UpChar ( EMPTY PAGES ARE FOUND WITH r307_library_scan )
+ *
+ * @param library LIBRARY VIEW
+ * @param stats scan_bytes IS INCREASED BY THE BYTES UPLOADED ( MAY BE NULL )
+ * @return RETURNS 0x00 ON SUCCESS, ELSE CONFIRMATION CODE OF THE FAILED COMMAND ( 0x01 IF UNANSWERED )
+ */
+uint8_t r307_sync_scan(r307_sync_library_t *library, r307_sync_stats_t *stats);
+
+/**
+ * @brief FUNCTION TO MAKE THE TARGET LIBRARY IDENTICAL TO THE SOURCE, COPYING ONLY MISSING OR CHANGED TEMPLATES
+ *
+ * @param source LIBRARY VIEW OF THE REFERENCE MODULE
+ * @param target LIBRARY VIEW OF THE MODULE TO UPDATE
+ * @param delete_extra 1 : ALSO DELETE TARGET PAGES THAT ARE EMPTY IN THE SOURCE
+ * @param stats FILLED WITH THE COUNTERS OF THIS SYNCHRONIZATION ( MAY BE NULL )
+ * @return RETURNS 0x00 ON SUCCESS, ELSE CONFIRMATION CODE OF THE FIRST FAILED COMMAND
+ */
+uint8_t r307_sync_run(r307_sync_library_t *source, r307_sync_library_t *target, uint8_t delete_extra, r307_sync_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // r307_sync_H
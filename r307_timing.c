@@ -0,0 +1,101 @@
+#include <stdint.h>
+#include "string.h"
+
+#include "esp_log.h"
+#include "nvs.h"
+
+#include "r307.h"
+#include "r307_timing.h"
+
+#define R307_TIMING_KEY "learned"               //++ NVS key of the record blob
+
+static const char *R307_TIMING = "R307_TIMING"; //++ Timing TAG
+
+static r307_timing_record_t timing_records[R307_TIMING_OPCODES];
+
+esp_err_t r307_timing_save(void)
+{
+    nvs_handle_t handle;
+    r307_command_timing_t timing;
+    int count = 0;
+
+    for(int i=0; i<R307_TIMING_OPCODES; i++)                                            //++ Only instructions that were actually measured
+    {
+        r307_get_command_timing(i, &timing);
+        if(timing.samples)
+        {
+            memset(&timing_records[count], 0, sizeof(timing_records[count]));
+            timing_records[count].instruction_code = i;
+            timing_records[count].samples = timing.samples;
+            timing_records[count].average_us = timing.average_us;
+            timing_records[count].deviation_us = timing.deviation_us;
+            timing_records[count].page_cost_us = timing.page_cost_us;
+            count++;
+        }
+    }
+
+    esp_err_t err = nvs_open(R307_TIMING_NAMESPACE, NVS_READWRITE, &handle);
+    if(err != ESP_OK)
+    {
+        return err;
+    }
+    if(count)
+    {
+        err = nvs_set_blob(handle, R307_TIMING_KEY, timing_records, count * sizeof(r307_timing_record_t));
+    }
+    else
+    {
+        err = nvs_erase_key(handle, R307_TIMING_KEY);
+        err = (err == ESP_ERR_NVS_NOT_FOUND) ? ESP_OK : err;
+    }
+    if(err == ESP_OK)
+    {
+        err = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    ESP_LOGI(R307_TIMING, "Saved latencies of %d instructions, %s", count, esp_err_to_name(err));
+
+    return err;
+}
+
+esp_err_t r307_timing_load(void)
+{
+    nvs_handle_t handle;
+    size_t length = sizeof(timing_records);
+    int count = 0;
+
+    esp_err_t err = nvs_open(R307_TIMING_NAMESPACE, NVS_READONLY, &handle);
+    if(err == ESP_OK)
+    {
+        err = nvs_get_blob(handle, R307_TIMING_KEY, timing_records, &length);
+        nvs_close(handle);
+        if(err == ESP_OK)
+        {
+            count = length / sizeof(r307_timing_record_t);
+        }
+    }
+    if(err == ESP_ERR_NVS_NOT_FOUND)                                                    //++ Nothing saved yet, keep the default deadlines
+    {
+        return ESP_OK;
+    }
+    if(err != ESP_OK)
+    {
+        ESP_LOGE(R307_TIMING, "Loading the latencies failed, %s", esp_err_to_name(err));
+        return err;
+    }
+
+    for(int i=0; i<count; i++)
+    {
+        r307_command_timing_t timing = {
+            .samples = timing_records[i].samples,
+            .average_us = timing_records[i].average_us,
+            .deviation_us = timing_records[i].deviation_us,
+            .page_cost_us = timing_records[i].page_cost_us,
+        };
+
+        r307_set_command_timing(timing_records[i].instruction_code, &timing);
+    }
+    ESP_LOGI(R307_TIMING, "Loaded latencies of %d instructions", count);
+
+    return ESP_OK;
+}
@@ -0,0 +1,46 @@
+#include <stdint.h>
+#include "esp_err.h"
+
+#include "r307.h"
+
+#ifndef r307_timing_H
+#define r307_timing_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define R307_TIMING_NAMESPACE "r307_timing"     //++ NVS namespace of the learned latencies
+
+/**
+ * @brief LEARNED LATENCY OF ONE INSTRUCTION AS SAVED IN NVS
+ */
+typedef struct
+{
+    uint8_t instruction_code;                   //++ Instruction Code
+    uint8_t reserved;
+    uint16_t page_cost_us;                      //++ Search & HighSpeedSearch : slowest latency per compared page ( 0 in records saved before it existed )
+    uint32_t samples;                           //++ Acknowledges measured
+    int32_t average_us;                         //++ Moving average of the latency
+    int32_t deviation_us;                       //++ Moving mean deviation of the latency
+} r307_timing_record_t;
+
+/**
+ * @brief FUNCTION TO SAVE THE LATENCIES LEARNED BY THE DRIVER, SO A REBOOT STARTS WITH TIGHT DEADLINES
+ *
+ * @return RETURNS ESP_OK OR THE NVS ERROR
+ */
+esp_err_t r307_timing_save(void);
+
+/**
+ * @brief FUNCTION TO RESTORE SAVED LATENCIES INTO THE DRIVER ( E.G. RIGHT AFTER r307_init ), NOTHING SAVED IS NOT AN ERROR
+ *
+ * @return RETURNS ESP_OK OR THE NVS ERROR
+ */
+esp_err_t r307_timing_load(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // r307_timing_H
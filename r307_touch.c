@@ -0,0 +1,155 @@
+#include <stdint.h>
+#include "string.h"
+
+#include "esp_log.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include "driver/gpio.h"
+
+#include "r307_touch.h"
+
+#define R307_TOUCH_STACK_SIZE (4096)            //++ Default stack size of the capture task
+#define R307_TOUCH_PRIORITY (5)                 //++ Default priority of the capture task
+#define R307_TOUCH_LIFT_POLL_MS (50)            //++ Poll period while waiting for the finger to be lifted
+
+static const char *R307_TOUCH = "R307_TOUCH";   //++ Touch TAG
+
+static r307_touch_config_t touch_config;        //++ Active touch configuration
+static SemaphoreHandle_t touch_semaphore;       //++ Given by the ISR when a finger lands
+static SemaphoreHandle_t touch_exited;          //++ Given by the capture task right before it deletes itself
+static TaskHandle_t touch_task_handle;          //++ Capture task
+static volatile uint8_t touch_running;          //++ 1 while the capture task should keep running
+
+static void IRAM_ATTR r307_touch_isr(void *arg)
+{
+    BaseType_t higher_priority_task_woken = pdFALSE;
+
+    gpio_intr_disable(touch_config.touch_pin);                                          //++ One wake-up per touch, re-armed once the finger is lifted
+    xSemaphoreGiveFromISR(touch_semaphore, &higher_priority_task_woken);
+    if(higher_priority_task_woken == pdTRUE)
+    {
+        portYIELD_FROM_ISR();
+    }
+}
+
+uint8_t r307_touch_finger_present(void)
+{
+    return gpio_get_level(touch_config.touch_pin) == touch_config.active_level;
+}
+
+static void r307_touch_task(void *arg)
+{
+    r307_identify_result_t result;
+
+    while(touch_running)
+    {
+        if(xSemaphoreTake(touch_semaphore, portMAX_DELAY) != pdTRUE || !touch_running)
+        {
+            continue;
+        }
+
+        ESP_LOGI(R307_TOUCH, "Finger detected, starting identify");
+        r307_identify(touch_config.r307_address, touch_config.library_size, &result);  //++ Capture immediately instead of polling GenImg
+
+        if(touch_config.callback != NULL)
+        {
+            touch_config.callback(&result, touch_config.callback_arg);
+        }
+
+        while(touch_running && r307_touch_finger_present())                             //++ Wait for the finger to be lifted before re-arming
+        {
+            vTaskDelay(R307_TOUCH_LIFT_POLL_MS / portTICK_PERIOD_MS);
+        }
+        gpio_intr_enable(touch_config.touch_pin);
+    }
+
+    xSemaphoreGive(touch_exited);
+    vTaskDelete(NULL);
+}
+
+esp_err_t r307_touch_start(const r307_touch_config_t *config)
+{
+    if(config == NULL || touch_task_handle != NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    memcpy(&touch_config, config, sizeof(touch_config));
+
+    if(touch_semaphore == NULL || touch_exited == NULL)
+    {
+        touch_semaphore = touch_semaphore ? touch_semaphore : xSemaphoreCreateBinary();
+        touch_exited = touch_exited ? touch_exited : xSemaphoreCreateBinary();
+        if(touch_semaphore == NULL || touch_exited == NULL)
+        {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    xSemaphoreTake(touch_semaphore, 0);                                                 //++ Drop a wake-up left over from the last stop
+
+    const gpio_config_t io_config =
+    {
+        .pin_bit_mask = 1ULL << touch_config.touch_pin,
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = touch_config.active_level ? GPIO_PULLUP_DISABLE : GPIO_PULLUP_ENABLE,
+        .pull_down_en = touch_config.active_level ? GPIO_PULLDOWN_ENABLE : GPIO_PULLDOWN_DISABLE,
+        .intr_type = touch_config.active_level ? GPIO_INTR_POSEDGE : GPIO_INTR_NEGEDGE,
+    };
+    esp_err_t err = gpio_config(&io_config);
+    if(err != ESP_OK)
+    {
+        return err;
+    }
+
+    err = gpio_install_isr_service(0);
+    if(err != ESP_OK && err != ESP_ERR_INVALID_STATE)                                   //++ Service may already be installed by the application
+    {
+        return err;
+    }
+
+    touch_running = 1;
+    if(xTaskCreate(r307_touch_task, "r307_touch",
+                   touch_config.task_stack_size ? touch_config.task_stack_size : R307_TOUCH_STACK_SIZE,
+                   NULL,
+                   touch_config.task_priority ? touch_config.task_priority : R307_TOUCH_PRIORITY,
+                   &touch_task_handle) != pdPASS)
+    {
+        touch_running = 0;
+        return ESP_ERR_NO_MEM;
+    }
+
+    err = gpio_isr_handler_add(touch_config.touch_pin, r307_touch_isr, NULL);
+    if(err != ESP_OK)
+    {
+        r307_touch_stop();
+        return err;
+    }
+
+    if(r307_touch_finger_present())                                                     //++ Finger already on the sensor, do not wait for an edge
+    {
+        gpio_intr_disable(touch_config.touch_pin);
+        xSemaphoreGive(touch_semaphore);
+    }
+
+    ESP_LOGI(R307_TOUCH, "Touch interrupt armed on GPIO %d", touch_config.touch_pin);
+    return ESP_OK;
+}
+
+esp_err_t r307_touch_stop(void)
+{
+    if(touch_task_handle == NULL || touch_task_handle == xTaskGetCurrentTaskHandle())  //++ Not from the callback, the task can't wait for itself
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    gpio_isr_handler_remove(touch_config.touch_pin);
+    touch_running = 0;
+    xSemaphoreGive(touch_semaphore);                                                    //++ Wake the capture task so it can exit
+    xSemaphoreTake(touch_exited, portMAX_DELAY);                                        //++ Returns once the task is gone, so r307_touch_start can follow at once
+    touch_task_handle = NULL;
+
+    return ESP_OK;
+}
@@ -0,0 +1,63 @@
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#include "r307_flow.h"
+
+#ifndef r307_touch_H
+#define r307_touch_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief CALLBACK CALLED FROM THE CAPTURE TASK EVERY TIME A FINGER LANDS ON THE SENSOR
+ *
+ * @param result RESULT OF THE IDENTIFY FLOW RUN FOR THIS TOUCH
+ * @param arg USER ARGUMENT GIVEN IN THE CONFIGURATION
+ */
+typedef void (*r307_touch_cb_t)(const r307_identify_result_t *result, void *arg);
+
+/**
+ * @brief CONFIGURATION OF THE FINGER PRESENCE ( TOUCH ) INTERRUPT
+ */
+typedef struct
+{
+    int touch_pin;                          //++ ESP32 GPIO wired to Pin 5 ( Touch Output ) of the sensor
+    int active_level;                       //++ Level of Pin 5 while a finger is on the sensor
+    char r307_address[4];                   //++ Module Address used by the identify flow
+    uint16_t library_size;                  //++ Number of pages searched by the identify flow
+    r307_touch_cb_t callback;               //++ Called with the identify result of every touch
+    void *callback_arg;                     //++ User argument passed to the callback
+    uint32_t task_stack_size;               //++ Stack size of the capture task ( 0 : Default )
+    unsigned int task_priority;             //++ Priority of the capture task ( 0 : Default )
+} r307_touch_config_t;
+
+/**
+ * @brief FUNCTION TO ARM THE TOUCH INTERRUPT & START THE CAPTURE TASK
+ *
+ * @param config TOUCH PIN, IDENTIFY PARAMETERS & CALLBACK
+ * @return RETURNS ESP_OK ON SUCCESS
+ */
+esp_err_t r307_touch_start(const r307_touch_config_t *config);
+
+/**
+ * @brief FUNCTION TO DISARM THE TOUCH INTERRUPT & STOP THE CAPTURE TASK, WAITS FOR A RUNNING IDENTIFY TO FINISH
+ *
+ * @return RETURNS ESP_OK ONCE THE TASK HAS EXITED, ESP_ERR_INVALID_STATE IF NOT RUNNING OR CALLED FROM THE TOUCH CALLBACK
+ */
+esp_err_t r307_touch_stop(void);
+
+/**
+ * @brief FUNCTION TO CHECK WHETHER A FINGER IS CURRENTLY ON THE SENSOR
+ *
+ * @return RETURNS 1 IF FINGER IS PRESENT, 0 OTHERWISE
+ */
+uint8_t r307_touch_finger_present(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // r307_touch_H
@@ -0,0 +1,417 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include "string.h"
+
+#include "esp_log.h"
+#include "nvs.h"
+
+#include "r307.h"
+#include "r307_flow.h"
+#include "r307_usermap.h"
+
+#define R307_USERMAP_KEY "entries"              //++ NVS key of the sorted entry blob
+#define R307_USERMAP_VERIFY_PAGES (10)          //++ Templates of one user tried by r307_usermap_verify
+
+static const char *R307_USERMAP = "R307_USERMAP";   //++ User Map TAG
+
+static int r307_usermap_compare(const void *a, const void *b)
+{
+    const r307_usermap_entry_t *entry_a = a;
+    const r307_usermap_entry_t *entry_b = b;
+
+    if(entry_a->user_id != entry_b->user_id)
+    {
+        return entry_a->user_id < entry_b->user_id ? -1 : 1;
+    }
+
+    return (int)entry_a->page_id - (int)entry_b->page_id;
+}
+
+static void r307_usermap_index(r307_usermap_t *map)
+{
+    for(int page=0; page<R307_USERMAP_MAX_PAGES; page++)
+    {
+        map->page_entry[page] = R307_USERMAP_NO_PAGE;
+    }
+    for(int i=0; i<map->count; i++)
+    {
+        map->page_entry[map->entries[i].page_id] = i;
+    }
+}
+
+static int r307_usermap_lower_bound(const r307_usermap_t *map, uint32_t user_id, uint16_t page_id)
+{
+    const r307_usermap_entry_t key = {.user_id = user_id, .page_id = page_id};
+    int low = 0;
+    int high = map->count;
+
+    while(low < high)
+    {
+        const int middle = (low + high) / 2;
+
+        if(r307_usermap_compare(&map->entries[middle], &key) < 0)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+static uint8_t r307_usermap_repair(r307_usermap_t *map)
+{
+    int kept = 0;
+    uint8_t sorted = 1;
+
+    for(int page=0; page<R307_USERMAP_MAX_PAGES; page++)
+    {
+        map->page_entry[page] = R307_USERMAP_NO_PAGE;                                   //++ Used as a seen marker here, rebuilt by r307_usermap_index
+    }
+    for(int i=0; i<map->count; i++)
+    {
+        sorted = sorted && (i == 0 || r307_usermap_compare(&map->entries[i - 1], &map->entries[i]) < 0);
+    }
+    if(!sorted)                                                                         //++ Binary search needs user_id then page_id order
+    {
+        qsort(map->entries, map->count, sizeof(r307_usermap_entry_t), r307_usermap_compare);
+    }
+
+    for(int i=0; i<map->count; i++)                                                     //++ page_entry[] must never be indexed out of range, a page has one owner
+    {
+        const uint16_t page_id = map->entries[i].page_id;
+
+        if(page_id >= R307_USERMAP_MAX_PAGES || map->page_entry[page_id] != R307_USERMAP_NO_PAGE)
+        {
+            continue;
+        }
+        map->page_entry[page_id] = kept;
+        map->entries[kept++] = map->entries[i];
+    }
+
+    const int dropped = map->count - kept;
+    map->count = kept;
+    if(!sorted || dropped)
+    {
+        ESP_LOGW(R307_USERMAP, "Stored map was %s, %d entries with an invalid or duplicate page dropped", sorted ? "sorted" : "unsorted", dropped);
+    }
+
+    return !sorted || dropped;
+}
+
+static esp_err_t r307_usermap_save(r307_usermap_t *map)
+{
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(map->nvs_namespace, NVS_READWRITE, &handle);
+
+    if(err != ESP_OK)
+    {
+        return err;
+    }
+    if(map->count)
+    {
+        err = nvs_set_blob(handle, R307_USERMAP_KEY, map->entries, map->count * sizeof(r307_usermap_entry_t));
+    }
+    else
+    {
+        err = nvs_erase_key(handle, R307_USERMAP_KEY);
+        err = (err == ESP_ERR_NVS_NOT_FOUND) ? ESP_OK : err;
+    }
+    if(err == ESP_OK)
+    {
+        err = nvs_commit(handle);
+    }
+    nvs_close(handle);
+
+    return err;
+}
+
+static esp_err_t r307_usermap_load(r307_usermap_t *map)
+{
+    nvs_handle_t handle;
+    size_t length = sizeof(map->entries);
+    esp_err_t err = ESP_OK;
+
+    if(map->loaded)
+    {
+        return ESP_OK;
+    }
+
+    map->count = 0;
+    err = nvs_open(map->nvs_namespace, NVS_READONLY, &handle);
+    if(err == ESP_OK)
+    {
+        err = nvs_get_blob(handle, R307_USERMAP_KEY, map->entries, &length);
+        nvs_close(handle);
+        if(err == ESP_OK)
+        {
+            map->count = length / sizeof(r307_usermap_entry_t);
+        }
+    }
+    if(err == ESP_ERR_NVS_NOT_FOUND)                                                    //++ Nothing saved yet, start with an empty map
+    {
+        err = ESP_OK;
+    }
+    if(err != ESP_OK)
+    {
+        ESP_LOGE(R307_USERMAP, "Loading the map failed, %s", esp_err_to_name(err));
+        return err;
+    }
+
+    const uint8_t repaired = r307_usermap_repair(map);
+    r307_usermap_index(map);
+    map->loaded = 1;
+    ESP_LOGI(R307_USERMAP, "Loaded %d mappings", map->count);
+    if(repaired)
+    {
+        err = r307_usermap_save(map);                                                   //++ Keep the repaired map, a failed save only repeats the repair next boot
+        if(err != ESP_OK)
+        {
+            ESP_LOGW(R307_USERMAP, "Saving the repaired map failed, %s", esp_err_to_name(err));
+        }
+    }
+
+    return ESP_OK;
+}
+
+static void r307_usermap_insert(r307_usermap_t *map, int index, uint32_t user_id, uint16_t page_id)
+{
+    memmove(&map->entries[index + 1], &map->entries[index], (map->count - index) * sizeof(r307_usermap_entry_t));
+    map->entries[index].user_id = user_id;
+    map->entries[index].page_id = page_id;
+    map->entries[index].reserved = 0;
+    map->count++;
+    r307_usermap_index(map);
+}
+
+static void r307_usermap_remove(r307_usermap_t *map, int index, int number)
+{
+    memmove(&map->entries[index], &map->entries[index + number], (map->count - index - number) * sizeof(r307_usermap_entry_t));
+    map->count -= number;
+    r307_usermap_index(map);
+}
+
+static uint8_t r307_usermap_delet_char(char r307_address[], int start, int run)
+{
+    char page_id[2] = {start >> 8, start & 0xFF};
+    char number_of_templates[2] = {run >> 8, run & 0xFF};
+    uint8_t confirmation_code = 0;
+
+    r307_link_acquire();                                                                //++ Acknowledge must be read before another task's command replaces it
+    confirmation_code = DeletChar(r307_address, page_id, number_of_templates);
+    confirmation_code = (confirmation_code == 0x00 && !r307_get_response()->received) ? 0x01 : confirmation_code;
+    r307_link_release();
+
+    return confirmation_code;
+}
+
+void r307_usermap_init(r307_usermap_t *map, const char *nvs_namespace)
+{
+    map->nvs_namespace = nvs_namespace ? nvs_namespace : R307_USERMAP_NAMESPACE;
+    map->loaded = 0;
+    map->count = 0;
+}
+
+int r307_usermap_find_pages(r307_usermap_t *map, uint32_t user_id, uint16_t page_ids[], int max_pages)
+{
+    int number = 0;
+
+    if(r307_usermap_load(map) != ESP_OK)
+    {
+        return 0;
+    }
+    for(int i=r307_usermap_lower_bound(map, user_id, 0); i<map->count && map->entries[i].user_id == user_id; i++)
+    {
+        if(number < max_pages)
+        {
+            page_ids[number] = map->entries[i].page_id;
+        }
+        number++;
+    }
+
+    return number;
+}
+
+esp_err_t r307_usermap_find_user(r307_usermap_t *map, uint16_t page_id, uint32_t *user_id)
+{
+    esp_err_t err = r307_usermap_load(map);
+
+    if(err != ESP_OK)
+    {
+        return err;
+    }
+    if(page_id >= R307_USERMAP_MAX_PAGES || map->page_entry[page_id] == R307_USERMAP_NO_PAGE)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+    *user_id = map->entries[map->page_entry[page_id]].user_id;
+
+    return ESP_OK;
+}
+
+esp_err_t r307_usermap_free_page(r307_usermap_t *map, uint16_t library_size, uint16_t *page_id)
+{
+    esp_err_t err = r307_usermap_load(map);
+
+    if(err != ESP_OK)
+    {
+        return err;
+    }
+    for(int page=0; page<library_size && page<R307_USERMAP_MAX_PAGES; page++)
+    {
+        if(map->page_entry[page] == R307_USERMAP_NO_PAGE)
+        {
+            *page_id = page;
+            return ESP_OK;
+        }
+    }
+
+    return ESP_ERR_NO_MEM;
+}
+
+esp_err_t r307_usermap_store(r307_usermap_t *map, char r307_address[], uint32_t user_id, char buffer_id[], uint16_t page_id)
+{
+    char page[2] = {page_id >> 8, page_id & 0xFF};
+    uint8_t confirmation_code = 0;
+    esp_err_t err = r307_usermap_load(map);
+
+    if(err != ESP_OK)
+    {
+        return err;
+    }
+    if(page_id >= R307_USERMAP_MAX_PAGES)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if(map->page_entry[page_id] != R307_USERMAP_NO_PAGE)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    r307_link_acquire();
+    confirmation_code = Store(r307_address, buffer_id, page);
+    confirmation_code = (confirmation_code == 0x00 && !r307_get_response()->received) ? 0x01 : confirmation_code;
+    r307_link_release();
+    if(confirmation_code != 0x00)
+    {
+        ESP_LOGE(R307_USERMAP, "Store to page %d failed, code 0x%02X", page_id, confirmation_code);
+        return ESP_FAIL;
+    }
+
+    const int index = r307_usermap_lower_bound(map, user_id, page_id);
+    r307_usermap_insert(map, index, user_id, page_id);
+    err = r307_usermap_save(map);
+    if(err != ESP_OK)                                                                   //++ Mapping not persisted : take the template back out of the library
+    {
+        ESP_LOGE(R307_USERMAP, "Saving the map failed, %s, rolling back page %d", esp_err_to_name(err), page_id);
+        r307_usermap_remove(map, index, 1);
+        r307_usermap_delet_char(r307_address, page_id, 1);
+    }
+
+    return err;
+}
+
+esp_err_t r307_usermap_delete_user(r307_usermap_t *map, char r307_address[], uint32_t user_id)
+{
+    esp_err_t err = r307_usermap_load(map);
+    int first = 0;
+    int last = 0;
+
+    if(err != ESP_OK)
+    {
+        return err;
+    }
+    first = r307_usermap_lower_bound(map, user_id, 0);
+    last = first;
+    while(last < map->count && map->entries[last].user_id == user_id)
+    {
+        last++;
+    }
+    if(first == last)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    for(int i=first; i<last; )                                                          //++ Pages of a user are sorted, contiguous ones share one DeletChar
+    {
+        int run = 1;
+        uint8_t confirmation_code = 0;
+
+        while(i + run < last && map->entries[i + run].page_id == map->entries[i].page_id + run)
+        {
+            run++;
+        }
+        confirmation_code = r307_usermap_delet_char(r307_address, map->entries[i].page_id, run);
+        if(confirmation_code != 0x00)                                                   //++ Mapping is kept, an unmatched page can't identify anyone
+        {
+            ESP_LOGE(R307_USERMAP, "DeletChar of page %d failed, code 0x%02X", map->entries[i].page_id, confirmation_code);
+            return ESP_FAIL;
+        }
+        i += run;
+    }
+
+    r307_usermap_remove(map, first, last - first);
+
+    return r307_usermap_save(map);
+}
+
+esp_err_t r307_usermap_remap(r307_usermap_t *map, const uint16_t remap[], uint16_t library_size)
+{
+    esp_err_t err = r307_usermap_load(map);
+    int count = 0;
+
+    if(err != ESP_OK)
+    {
+        return err;
+    }
+    for(int i=0; i<map->count; i++)
+    {
+        const uint16_t page_id = map->entries[i].page_id;
+        const uint16_t new_page_id = page_id < library_size ? remap[page_id] : page_id;
+
+        if(new_page_id == R307_USERMAP_NO_PAGE || new_page_id >= R307_USERMAP_MAX_PAGES)   //++ Page was empty in the library, drop the stale mapping
+        {
+            continue;
+        }
+        map->entries[count] = map->entries[i];
+        map->entries[count].page_id = new_page_id;
+        count++;
+    }
+    map->count = count;
+    qsort(map->entries, map->count, sizeof(r307_usermap_entry_t), r307_usermap_compare);
+    r307_usermap_index(map);
+
+    return r307_usermap_save(map);
+}
+
+uint8_t r307_usermap_identify(r307_usermap_t *map, char r307_address[], uint16_t library_size, r307_identify_result_t *result, uint32_t *user_id)
+{
+    uint8_t confirmation_code = r307_identify(r307_address, library_size, result);
+
+    if(confirmation_code == 0x00 && r307_usermap_find_user(map, result->page_id, user_id) != ESP_OK)
+    {
+        ESP_LOGW(R307_USERMAP, "Matched page %d is not mapped to a user", result->page_id);
+        confirmation_code = 0x09;                                                       //++ Report as No Matching Finger Found
+        result->confirmation_code = confirmation_code;
+    }
+
+    return confirmation_code;
+}
+
+uint8_t r307_usermap_verify(r307_usermap_t *map, char r307_address[], uint32_t user_id, r307_verify_result_t *result)
+{
+    uint16_t page_ids[R307_USERMAP_VERIFY_PAGES];
+    int count = r307_usermap_find_pages(map, user_id, page_ids, R307_USERMAP_VERIFY_PAGES);
+
+    if(count == 0)
+    {
+        memset(result, 0, sizeof(*result));
+        result->confirmation_code = 0x08;
+        return 0x08;
+    }
+
+    return r307_verify_pages(r307_address, page_ids, count < R307_USERMAP_VERIFY_PAGES ? count : R307_USERMAP_VERIFY_PAGES, result);
+}
@@ -0,0 +1,139 @@
+#include <stdint.h>
+#include "esp_err.h"
+
+#include "r307.h"
+#include "r307_flow.h"
+
+#ifndef r307_usermap_H
+#define r307_usermap_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define R307_USERMAP_MAX_PAGES (1000)           //++ Library pages that can be mapped ( R307 capacity )
+#define R307_USERMAP_NO_PAGE (0xFFFF)           //++ page_entry value of an unmapped page
+#define R307_USERMAP_NAMESPACE "r307_map"       //++ Default NVS namespace
+
+/**
+ * @brief ONE USER-ID TO PAGE-ID MAPPING, ENTRIES ARE KEPT SORTED BY user_id THEN page_id
+ */
+typedef struct
+{
+    uint32_t user_id;                                           //++ Application User ID
+    uint16_t page_id;                                           //++ Library page holding one of the user's templates
+    uint16_t reserved;
+} r307_usermap_entry_t;
+
+/**
+ * @brief MAPPING STORE, LOADED FROM NVS ON FIRST USE
+ */
+typedef struct
+{
+    const char *nvs_namespace;                                  //++ NULL : R307_USERMAP_NAMESPACE
+    uint8_t loaded;                                             //++ 1 : entries hold the NVS contents
+    uint16_t count;                                             //++ Entries in use
+    r307_usermap_entry_t entries[R307_USERMAP_MAX_PAGES];       //++ Sorted index, searched by user_id
+    uint16_t page_entry[R307_USERMAP_MAX_PAGES];                //++ Index of the entry of every page, searched by page_id
+} r307_usermap_t;
+
+/**
+ * @brief FUNCTION TO INITIALIZE AN EMPTY MAPPING STORE, NOTHING IS READ UNTIL THE FIRST LOOKUP
+ *
+ * @param map MAPPING STORE
+ * @param nvs_namespace NVS NAMESPACE ( NULL FOR R307_USERMAP_NAMESPACE, nvs_flash_init MUST HAVE BEEN CALLED )
+ * @return
+ */
+void r307_usermap_init(r307_usermap_t *map, const char *nvs_namespace);
+
+/**
+ * @brief FUNCTION TO FIND THE PAGES OF A USER ( BINARY SEARCH )
+ *
+ * @param map MAPPING STORE
+ * @param user_id APPLICATION USER ID
+ * @param page_ids FILLED WITH THE USER'S PAGES IN ASCENDING ORDER
+ * @param max_pages SIZE OF page_ids
+ * @return RETURNS NUMBER OF PAGES OF THE USER ( MAY EXCEED max_pages )
+ */
+int r307_usermap_find_pages(r307_usermap_t *map, uint32_t user_id, uint16_t page_ids[], int max_pages);
+
+/**
+ * @brief FUNCTION TO FIND THE USER OWNING A PAGE ( E.G. THE PAGE RETURNED BY Search )
+ *
+ * @param map MAPPING STORE
+ * @param page_id LIBRARY PAGE
+ * @param user_id FILLED WITH THE APPLICATION USER ID
+ * @return RETURNS ESP_OK, ESP_ERR_NOT_FOUND IF THE PAGE IS NOT MAPPED
+ */
+esp_err_t r307_usermap_find_user(r307_usermap_t *map, uint16_t page_id, uint32_t *user_id);
+
+/**
+ * @brief FUNCTION TO FIND THE LOWEST PAGE NOT MAPPED TO ANY USER
+ *
+ * @param map MAPPING STORE
+ * @param library_size PAGES IN THE LIBRARY
+ * @param page_id FILLED WITH THE FREE PAGE
+ * @return RETURNS ESP_OK, ESP_ERR_NO_MEM IF EVERY PAGE IS MAPPED
+ */
+esp_err_t r307_usermap_free_page(r307_usermap_t *map, uint16_t library_size, uint16_t *page_id);
+
+/**
+ * @brief FUNCTION TO STORE A CHARBUFFER TO A PAGE WITH Store & MAP THE PAGE TO A USER, BOTH OR NEITHER
+ *
+ * @param map MAPPING STORE
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @param user_id APPLICATION USER ID
+ * @param buffer_id CHARBUFFER TO STORE
+ * @param page_id FREE LIBRARY PAGE
+ * @return RETURNS ESP_OK, ESP_ERR_INVALID_STATE IF THE PAGE IS MAPPED, ESP_FAIL IF Store FAILED
+ */
+esp_err_t r307_usermap_store(r307_usermap_t *map, char r307_address[], uint32_t user_id, char buffer_id[], uint16_t page_id);
+
+/**
+ * @brief FUNCTION TO DELETE EVERY TEMPLATE OF A USER FROM THE LIBRARY & THE MAPPING
+ *
+ * @param map MAPPING STORE
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @param user_id APPLICATION USER ID
+ * @return RETURNS ESP_OK, ESP_ERR_NOT_FOUND IF THE USER HAS NO PAGES, ESP_FAIL IF DeletChar FAILED
+ */
+esp_err_t r307_usermap_delete_user(r307_usermap_t *map, char r307_address[], uint32_t user_id);
+
+/**
+ * @brief FUNCTION TO APPLY A COMPACTION REMAP TABLE ( r307_library_compact ) TO THE MAPPING
+ *
+ * @param map MAPPING STORE
+ * @param remap NEW PAGE OF EVERY OLD PAGE
+ * @param library_size ENTRIES IN remap
+ * @return RETURNS ESP_OK OR THE NVS ERROR
+ */
+esp_err_t r307_usermap_remap(r307_usermap_t *map, const uint16_t remap[], uint16_t library_size);
+
+/**
+ * @brief FUNCTION TO IDENTIFY A FINGER ( r307_identify ) & RESOLVE THE MATCHED PAGE TO ITS USER
+ *
+ * @param map MAPPING STORE
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @param library_size NUMBER OF PAGES TO SEARCH FROM PAGE 0
+ * @param result FILLED WITH THE IDENTIFY RESULT
+ * @param user_id FILLED WITH THE APPLICATION USER ID ( ONLY IF A MAPPED PAGE MATCHED )
+ * @return RETURNS CONFIRMATION CODE OF THE FLOW, 0x09 IF THE MATCHED PAGE IS NOT MAPPED
+ */
+uint8_t r307_usermap_identify(r307_usermap_t *map, char r307_address[], uint16_t library_size, r307_identify_result_t *result, uint32_t *user_id);
+
+/**
+ * @brief FUNCTION TO VERIFY A FINGER AGAINST THE TEMPLATES OF A CLAIMED USER ( r307_verify_pages ), STOPPING AT THE FIRST MATCH
+ *
+ * @param map MAPPING STORE
+ * @param r307_address CURRENT MODULE ADDRESS
+ * @param user_id CLAIMED APPLICATION USER ID ( E.G. FROM A BADGE )
+ * @param result FILLED WITH THE VERIFY RESULT
+ * @return RETURNS CONFIRMATION CODE OF THE FLOW, 0x08 IF THE USER HAS NO PAGES OR NONE MATCHES
+ */
+uint8_t r307_usermap_verify(r307_usermap_t *map, char r307_address[], uint32_t user_id, r307_verify_result_t *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // r307_usermap_H